@@ -0,0 +1,74 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <fstream>
+#include "dataset.h"
+
+Vector2D read2d(const std::filesystem::path &filename) {
+    Vector2D ret;
+    std::ifstream in(filename, std::ios_base::in);
+    while (in.good()) {
+        Vector row;
+        row.reserve(2);
+
+        int idx = 0;
+        in >> idx;
+        if (in.peek() == ',') in.ignore();
+        for (DataType x; in >> x;) {
+            row.emplace_back(x);
+            if (in.peek() == ',') {
+                in.ignore();
+            } else if (in.peek() == '\n') {
+                break;
+            }
+        }
+
+        ret.emplace_back(std::move(row));
+    }
+    return ret;
+}
+
+Vector read1d(const std::filesystem::path &filename) {
+    Vector ret;
+    std::ifstream in(filename, std::ios_base::in);
+    while (in.good()) {
+        int idx = 0;
+        DataType x = 0;
+        in >> idx;
+        if (in.peek() == ',') in.ignore();
+        in >> x;
+        ret.emplace_back(x);
+    }
+    return ret;
+}
+
+Dataset Dataset::read(const std::filesystem::path &xFile, const std::filesystem::path &yFile) {
+    Dataset ret;
+    for (auto &row: read2d(xFile)) {
+        std::vector<DataType> x;
+        x.reserve(row.size());
+        for (auto &v: row) {
+            x.push_back(v->data());
+        }
+        ret.X.push_back(std::move(x));
+    }
+    for (auto &v: read1d(yFile)) {
+        ret.y.push_back(v->data());
+    }
+    return ret;
+}
+
+Vector2D Dataset::values() const {
+    Vector2D ret;
+    ret.reserve(X.size());
+    for (auto &row: X) {
+        Vector x;
+        x.reserve(row.size());
+        for (auto v: row) {
+            x.emplace_back(v);
+        }
+        ret.push_back(std::move(x));
+    }
+    return ret;
+}
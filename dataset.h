@@ -0,0 +1,32 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_DATASET_H
+#define MICROGRAD_DATASET_H
+
+#include <filesystem>
+#include "engine.h"
+
+/// Read a 2d csv file (first column is the row index) into rows of values.
+Vector2D read2d(const std::filesystem::path &filename);
+
+/// Read a 1d csv file (first column is the row index) into a vector of values.
+Vector read1d(const std::filesystem::path &filename);
+
+/**
+ * Plain data of a dataset, can be shared read-only by models trained on different threads
+ * (Values can not: backward writes into them).
+ */
+struct Dataset {
+    std::vector<std::vector<DataType>> X;
+    std::vector<DataType> y;
+
+    /// Read features and labels from csv files in the format of read2d / read1d.
+    static Dataset read(const std::filesystem::path &xFile, const std::filesystem::path &yFile);
+
+    /// Fresh leaf values of the features, for a graph owned by the caller.
+    [[nodiscard]] Vector2D values() const;
+};
+
+#endif //MICROGRAD_DATASET_H
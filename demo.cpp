@@ -3,50 +3,13 @@
 //
 
 #include <iostream>
-#include <fstream>
 #include <filesystem>
 #include <vector>
 #include <matplot/matplot.h>
 #include "engine.h"
 #include "neuronet.h"
-
-Vector2D read2d(const std::filesystem::path &filename) {
-    Vector2D ret;
-    std::ifstream in(filename, std::ios_base::in);
-    while (in.good()) {
-        Vector row;
-        row.reserve(2);
-
-        int idx = 0;
-        in >> idx;
-        if (in.peek() == ',') in.ignore();
-        for (DataType x; in >> x;) {
-            row.emplace_back(x);
-            if (in.peek() == ',') {
-                in.ignore();
-            } else if (in.peek() == '\n') {
-                break;
-            }
-        }
-
-        ret.emplace_back(std::move(row));
-    }
-    return ret;
-}
-
-Vector read1d(const std::filesystem::path &filename) {
-    Vector ret;
-    std::ifstream in(filename, std::ios_base::in);
-    while (in.good()) {
-        int idx = 0;
-        DataType x = 0;
-        in >> idx;
-        if (in.peek() == ',') in.ignore();
-        in >> x;
-        ret.emplace_back(x);
-    }
-    return ret;
-}
+#include "dataset.h"
+#include "loss.h"
 
 void plot(const Vector2D &X, const Vector &Y) {
     using namespace matplot;
@@ -116,19 +79,25 @@ int main() {
     MLP model(2, {16, 16, 1});
     std::cout << "Number of parameters: " << model.parameters().size() << "\n";
 
+    std::vector<DataType> labels;
+    labels.reserve(N);
+    for (auto &v: y) {
+        labels.push_back(v->data());
+    }
+
     int n = 200;
 
     for (int k = 0; k < n; ++k) {
-        Vector losses;
-        losses.reserve(N);
+        Vector scores;
+        scores.reserve(N);
         double accuracy = 0;
         for (int i = 0; i < N; ++i) {
             Value score = model(X[i])[0];
-            losses.push_back((1 - y[i] * score).relu());
+            scores.push_back(score);
             accuracy += (y[i]->data() > 0) == (score->data() > 0);
         }
         accuracy /= N;
-        Value dataLoss = std::accumulate(losses.begin(), losses.end(), Value(0)) / N;
+        Value dataLoss = hinge_loss(scores, labels);
 
         auto alpha = 1e-4;
         auto params = model.parameters();
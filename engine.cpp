@@ -2,6 +2,10 @@
 // Created by Xiaofeng Li on 18/9/2024.
 //
 
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
 #include "engine.h"
 
 void empty_backward() {}
@@ -10,8 +14,8 @@ ValueData::ValueData() : ValueData(0, "val", {}, "") {}
 
 ValueData::ValueData(DataType data) : ValueData(data, "val", {}, "") {}
 
-ValueData::ValueData(DataType data, std::string op, std::vector<Pointer> prev, std::string label)
-        : _data(data), _grad(0.0), _op(std::move(op)), _prev(std::move(prev)), _label(std::move(label)),
+ValueData::ValueData(DataType data, std::string op, Prev prev, std::string label)
+        : _data(data), _grad(0.0), _op(std::move(op)), _prev(std::move(prev)), _label(std::move(label)), _arg(0),
           _backwardFunction(empty_backward) {}
 
 DataType &ValueData::data() {
@@ -22,7 +26,7 @@ DataType &ValueData::grad() {
     return _grad;
 }
 
-const std::vector<ValueDataPtr> &ValueData::prev() const {
+const ValueData::Prev &ValueData::prev() const {
     return _prev;
 }
 
@@ -38,6 +42,14 @@ void ValueData::label(std::string label) {
     _label = std::move(label);
 }
 
+DataType ValueData::arg() const {
+    return _arg;
+}
+
+void ValueData::arg(DataType arg) {
+    _arg = arg;
+}
+
 ValueData &ValueData::operator<<(BackwardFunc backward) {
     _backwardFunction = std::move(backward);
     return *this;
@@ -47,14 +59,58 @@ void ValueData::backward() {
     _backwardFunction();
 }
 
-Value::Value() : Value(0) {}
+void ValueData::forward(ForwardFunc forward) {
+    _customForward = std::make_unique<ForwardFunc>(std::move(forward));
+}
 
-Value::Value(DataType data, const std::string &label) : _valueData(std::make_shared<ValueData>(data)) {
-_valueData->label(label);
+void ValueData::forward() {
+    if (_customForward) {
+        (*_customForward)();
+        return;
+    }
+    if (_prev.empty()) return;
+    DataType x = _prev[0]->_data;
+    DataType y = _prev.size() > 1 ? _prev[1]->_data : 0;
+    // the built-in ops of the operators below, their names start with distinct characters
+    switch (_op.front()) {
+        case '+':
+            _data = x + y;
+            break;
+        case '-':
+            _data = x - y;
+            break;
+        case '*':
+            _data = x * y;
+            break;
+        case 'n':
+            _data = -x;
+            break;
+        case 'p':
+            _data = std::pow(x, _arg);
+            break;
+        case 'e':
+            _data = std::exp(x);
+            break;
+        case 'r':
+            _data = std::max(0.0, x);
+            break;
+        case 't':
+            _data = std::tanh(x);
+            break;
+        default:
+            break;
+    }
 }
 
-Value::Value(DataType data, const std::string &op, const std::vector<ValueDataPtr> &prev) : _valueData(
-        std::make_shared<ValueData>(data, op, prev, "")) {}
+Value::Value() : Value(0) {}
+
+Value::Value(DataType data, const std::string &label) : _valueData(
+        std::allocate_shared<ValueData>(PoolAllocator<ValueData>(), data, "val", ValueData::Prev{}, label)) {}
+
+Value::Value(DataType data, const std::string &op, ValueData::Prev prev) : _valueData(
+        std::allocate_shared<ValueData>(PoolAllocator<ValueData>(), data, op, std::move(prev), "")) {}
+
+Value::Value(ValueDataPtr valueData) : _valueData(std::move(valueData)) {}
 
 ValueData *Value::operator->() const {
     return _valueData.get();
@@ -77,11 +133,13 @@ ValueData *Value::raw_pointer() const {
     return _valueData.get();
 }
 
+// Backward functions only hold a raw pointer to their own node: capturing the Value would keep the node alive
+// through its own closure and leak the whole graph.
 Value Value::exp() {
     auto x = Value(std::exp(_valueData->data()), "exp", {pointer()});
     auto valueData = _valueData;
-    x << [=] {
-        valueData->grad() += x->grad() * x->data();
+    x << [=, out = x.raw_pointer()] {
+        valueData->grad() += out->grad() * out->data();
     };
 
     return x;
@@ -89,9 +147,10 @@ Value Value::exp() {
 
 Value Value::pow(DataType a) const {
     auto x = Value(std::pow(_valueData->data(), a), "power", {pointer()});
+    x->arg(a);
     auto lh = _valueData;
-    x << [=] {
-        lh->grad() += x->grad() * a * std::pow(lh->data(), a - 1);
+    x << [=, out = x.raw_pointer()] {
+        lh->grad() += out->grad() * a * std::pow(lh->data(), a - 1);
     };
 
     return x;
@@ -100,8 +159,8 @@ Value Value::pow(DataType a) const {
 Value Value::relu() {
     auto x = Value(std::max(0.0, _valueData->data()), "relu", {pointer()});
     auto valueData = _valueData;
-    x << [=, this] {
-        valueData->grad() += x->grad() * (x->data() > 0 ? 1 : 0);
+    x << [=, out = x.raw_pointer()] {
+        valueData->grad() += out->grad() * (out->data() > 0 ? 1 : 0);
     };
 
     return x;
@@ -110,8 +169,8 @@ Value Value::relu() {
 Value Value::tanh() {
     auto x = Value(std::tanh(_valueData->data()), "tanh", {pointer()});
     auto valueData = _valueData;
-    x << [=] {
-        valueData->grad() += x->grad() * (1 - x->data() * x->data());
+    x << [=, out = x.raw_pointer()] {
+        valueData->grad() += out->grad() * (1 - out->data() * out->data());
     };
     return x;
 }
@@ -128,6 +187,12 @@ public:
         dfs(root);
     }
 
+    explicit Topo(const Vector &roots) {
+        for (auto &r: roots) {
+            dfs(r.raw_pointer());
+        }
+    }
+
     auto order() {
         return std::ranges::reverse_view(*this);
     }
@@ -150,13 +215,173 @@ private:
 /// - Grad on the current node is always 1: as it's just identity function: y = x
 /// - Then we update grads in topological order
 void Value::backward() {
-    _valueData->grad() = 1;
     Topo topo(raw_pointer());
+    // intermediate grads may be left over from a previous pass on the same graph (see recompute())
+    for (auto p: topo) {
+        if (!p->prev().empty()) p->grad() = 0;
+    }
+    _valueData->grad() = 1;
+    for (auto p: topo.order()) {
+        p->backward();
+    }
+}
+
+void backward(const Vector &roots, const std::vector<DataType> &grads) {
+    if (grads.size() != roots.size()) {
+        throw std::invalid_argument("backward: " + std::to_string(roots.size()) + " roots but " +
+                                    std::to_string(grads.size()) + " grads");
+    }
+    Topo topo(roots);
+    for (auto p: topo) {
+        if (!p->prev().empty()) p->grad() = 0;
+    }
+    for (size_t i = 0; i < roots.size(); ++i) {
+        roots[i]->grad() += grads[i];
+    }
     for (auto p: topo.order()) {
         p->backward();
     }
 }
 
+IncrementalGraph::IncrementalGraph(const Value &root) : IncrementalGraph(Vector{root}) {}
+
+IncrementalGraph::IncrementalGraph(const Vector &roots) : _roots(roots) {
+    Topo topo(roots);
+    _nodes.assign(topo.begin(), topo.end());
+    std::unordered_map<ValueData *, size_t> index;
+    index.reserve(_nodes.size());
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        index[_nodes[i]] = i;
+        _snapshot.push_back(_nodes[i]->data());
+        if (_nodes[i]->prev().empty()) _leaves.push_back(i);
+    }
+    for (auto &r: roots) {
+        _rootIndices.push_back(index[r.raw_pointer()]);
+    }
+
+    // parent and child lists as index ranges, a parent used twice (x * x) is listed twice
+    std::vector<size_t> childCount(_nodes.size() + 1, 0);
+    _parentBegin.push_back(0);
+    for (auto n: _nodes) {
+        for (auto &p: n->prev()) {
+            _parents.push_back(index[p.get()]);
+            ++childCount[index[p.get()]];
+        }
+        _parentBegin.push_back(_parents.size());
+    }
+    _childBegin.assign(_nodes.size() + 1, 0);
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        _childBegin[i + 1] = _childBegin[i] + childCount[i];
+    }
+    _children.resize(_parents.size());
+    std::vector<size_t> fill(_childBegin.begin(), _childBegin.end() - 1);
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        for (size_t k = _parentBegin[i]; k < _parentBegin[i + 1]; ++k) {
+            _children[fill[_parents[k]]++] = i;
+        }
+    }
+    _mark.assign(_nodes.size(), false);
+}
+
+size_t IncrementalGraph::recompute() {
+    // min-heap of stale nodes by topological index: a node is only evaluated after all its stale parents
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<>> stale;
+    auto propagate = [&](size_t i) {
+        for (size_t k = _childBegin[i]; k < _childBegin[i + 1]; ++k) {
+            auto c = _children[k];
+            if (!_mark[c]) {
+                _mark[c] = true;
+                stale.push(c);
+            }
+        }
+    };
+
+    _changed.clear();
+    for (auto i: _leaves) {
+        if (_nodes[i]->data() != _snapshot[i]) {
+            _snapshot[i] = _nodes[i]->data();
+            _changed.push_back(i);
+            propagate(i);
+        }
+    }
+    size_t count = 0;
+    while (!stale.empty()) {
+        auto i = stale.top();
+        stale.pop();
+        _mark[i] = false;
+        _nodes[i]->forward();
+        ++count;
+        if (_nodes[i]->data() != _snapshot[i]) {
+            _snapshot[i] = _nodes[i]->data();
+            propagate(i);
+        }
+    }
+    return count;
+}
+
+void IncrementalGraph::backward() {
+    backward(std::vector<DataType>(_roots.size(), 1));
+}
+
+void IncrementalGraph::backward(const std::vector<DataType> &grads) {
+    if (grads.size() != _rootIndices.size()) {
+        throw std::invalid_argument("IncrementalGraph::backward: " + std::to_string(_rootIndices.size()) +
+                                    " roots but " + std::to_string(grads.size()) + " grads");
+    }
+    // every node downstream of a changed leaf, whether its value changed or not: the grad flows through it anyway
+    std::vector<size_t> dirty;
+    std::vector<size_t> todo(_changed.begin(), _changed.end());
+    for (auto i: todo) _mark[i] = true;
+    while (!todo.empty()) {
+        auto i = todo.back();
+        todo.pop_back();
+        for (size_t k = _childBegin[i]; k < _childBegin[i + 1]; ++k) {
+            auto c = _children[k];
+            if (!_mark[c]) {
+                _mark[c] = true;
+                dirty.push_back(c);
+                todo.push_back(c);
+            }
+        }
+    }
+    std::ranges::sort(dirty);
+
+    // the children of a dirty node are dirty, so their grads are complete; parents outside the set only get a
+    // part of theirs, so their grads are saved and restored
+    std::vector<std::pair<size_t, DataType>> outside;
+    for (auto i: dirty) {
+        _nodes[i]->grad() = 0;
+        for (size_t k = _parentBegin[i]; k < _parentBegin[i + 1]; ++k) {
+            auto p = _parents[k];
+            if (!_mark[p]) {
+                _mark[p] = true;
+                outside.emplace_back(p, _nodes[p]->grad());
+            }
+        }
+    }
+    for (size_t r = 0; r < _rootIndices.size(); ++r) {
+        if (_mark[_rootIndices[r]]) _nodes[_rootIndices[r]]->grad() += grads[r];
+    }
+    for (auto it = dirty.rbegin(); it != dirty.rend(); ++it) {
+        _nodes[*it]->backward();
+    }
+    for (auto [p, grad]: outside) {
+        _nodes[p]->grad() = grad;
+        _mark[p] = false;
+    }
+    for (auto list: {&_changed, &dirty}) {
+        for (auto i: *list) _mark[i] = false;
+    }
+}
+
+size_t IncrementalGraph::size() const {
+    return _nodes.size();
+}
+
+size_t IncrementalGraph::changedLeaves() const {
+    return _changed.size();
+}
+
 Value &operator^=(Value &lh, DataType rh) {
     lh = lh.pow(rh);
     return lh;
@@ -164,9 +389,9 @@ Value &operator^=(Value &lh, DataType rh) {
 
 Value operator+(const Value &lh, const Value &rh) {
     auto x = Value(lh->data() + rh->data(), "+", {lh.pointer(), rh.pointer()});
-    x << [=] {
-        lh->grad() += x->grad();
-        rh->grad() += x->grad();
+    x << [=, out = x.raw_pointer()] {
+        lh->grad() += out->grad();
+        rh->grad() += out->grad();
     };
     return x;
 }
@@ -181,9 +406,9 @@ Value operator+(DataType lh, const Value &rh) {
 
 Value operator-(const Value &lh, const Value &rh) {
     auto x = Value(lh->data() - rh->data(), "-", {lh.pointer(), rh.pointer()});
-    x << [=] {
-        lh->grad() += x->grad();
-        rh->grad() -= x->grad();
+    x << [=, out = x.raw_pointer()] {
+        lh->grad() += out->grad();
+        rh->grad() -= out->grad();
     };
     return x;
 }
@@ -198,8 +423,8 @@ Value operator-(DataType lh, const Value &rh) {
 
 Value operator-(const Value &v) {
     auto x = Value(-v->data(), "neg", {v.pointer()});
-    x << [=] {
-        v->grad() -= x->grad();
+    x << [=, out = x.raw_pointer()] {
+        v->grad() -= out->grad();
     };
     return x;
 }
@@ -207,9 +432,9 @@ Value operator-(const Value &v) {
 
 Value operator*(const Value &lh, const Value &rh) {
     auto x = Value(lh->data() * rh->data(), "*", {lh.pointer(), rh.pointer()});
-    x << [=] {
-        lh->grad() += x->grad() * rh->data();
-        rh->grad() += x->grad() * lh->data();
+    x << [=, out = x.raw_pointer()] {
+        lh->grad() += out->grad() * rh->data();
+        rh->grad() += out->grad() * lh->data();
     };
     return x;
 }
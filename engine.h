@@ -15,12 +15,15 @@
 #include <utility>
 #include <vector>
 #include <sstream>
+#include "pool.h"
 
 
 /// Type of data in each node: double
 using DataType = double;
 /// Backward function signature;
 using BackwardFunc = std::function<void()>;
+/// Forward function signature: re-evaluates a custom node (e.g. a fused loss) from its parents.
+using ForwardFunc = std::function<void()>;
 
 /// Default backward function: does nothing.
 void empty_backward();
@@ -31,12 +34,14 @@ void empty_backward();
 class ValueData {
 public:
     using Pointer = std::shared_ptr<ValueData>;
+    /// Parents of a node, allocated from the slab pools like the node itself.
+    using Prev = std::vector<Pointer, PoolAllocator<Pointer>>;
 
     ValueData();
 
     explicit ValueData(DataType data);
 
-    ValueData(DataType data, std::string op, std::vector<Pointer> prev, std::string label);
+    ValueData(DataType data, std::string op, Prev prev, std::string label);
 
     /// Reference to the current value, can be used to update.
     DataType &data();
@@ -45,7 +50,7 @@ public:
     DataType &grad();
 
     /// Reference to parents, could be empty if the value is created from scratch.
-    const std::vector<Pointer> &prev() const;
+    const Prev &prev() const;
 
     /// Operation used to generate the value from its parents.
     std::string op() const;
@@ -56,19 +61,35 @@ public:
     /// Update label
     void label(std::string label);
 
+    /// Scalar argument of the operation, e.g. the exponent of power.
+    [[nodiscard]] DataType arg() const;
+
+    /// Update scalar argument
+    void arg(DataType arg);
+
     /// Update backward function
     ValueData &operator<<(BackwardFunc backward);
 
     /// Call backward function on the current node.
     void backward();
 
+    /// Set the forward function of a custom op, built-in ops (see operators below) are re-evaluated from op() and
+    /// arg() and need none.
+    void forward(ForwardFunc forward);
+
+    /// Re-evaluate the node from the current data of its parents.
+    void forward();
+
 private:
     DataType _data;
     DataType _grad;
     std::string _op;
-    std::vector<Pointer> _prev;
+    Prev _prev;
     std::string _label;
+    DataType _arg;
     BackwardFunc _backwardFunction;
+    /// Forward function of a custom op, null for the built-in ones: they would pay for a closure on every node.
+    std::unique_ptr<ForwardFunc> _customForward;
 };
 
 /// Alias for value data pointer type.
@@ -83,7 +104,10 @@ public:
 
     explicit Value(DataType data, const std::string &label = "");
 
-    Value(DataType data, const std::string &op, const std::vector<ValueDataPtr> &prev);
+    Value(DataType data, const std::string &op, ValueData::Prev prev);
+
+    /// Wrap existing value data, e.g. one element of a block of parameters.
+    explicit Value(ValueDataPtr valueData);
 
     Value(const Value &other) = default;
 
@@ -172,5 +196,61 @@ Value operator/(const Value &lh, DataType rh);
 
 Value operator/(DataType lh, const Value &rh);
 
+/// Backward from several roots at once, each seeded with its grad, e.g. the outputs of a sub-network whose grads
+/// come from the layers after it. Throws std::invalid_argument if the sizes differ.
+void backward(const Vector &roots, const std::vector<DataType> &grads);
+
+/**
+ * A kept graph that is re-evaluated after mutating leaves. The topological order, child lists and a snapshot of
+ * every node's data are taken once at construction, each recompute() then only visits nodes downstream of the leaves
+ * whose data() differs from the snapshot. Snapshots belong to the graph, not to the nodes, so graphs sharing leaves
+ * (e.g. weights) do not consume each other's changes; several roots sharing leaves should be passed together.
+ */
+class IncrementalGraph {
+public:
+    explicit IncrementalGraph(const Value &root);
+
+    explicit IncrementalGraph(const Vector &roots);
+
+    /// Re-evaluate, in topological order, the nodes downstream of leaves changed since the last call,
+    /// a node whose value stays the same (e.g. a relu staying at 0) does not propagate further.
+    /// \return number of re-evaluated nodes
+    size_t recompute();
+
+    /// Backward restricted to the nodes downstream of the leaves changed in the last recompute(), roots seeded with 1.
+    /// Only the changed leaves (and those downstream nodes) get their grads: they are accumulated exactly as
+    /// backward() would. Grads of every other node are left untouched, as computing them needs a full backward().
+    void backward();
+
+    /// Same as backward(), each root seeded with its grad. Throws std::invalid_argument if the sizes differ.
+    void backward(const std::vector<DataType> &grads);
+
+    /// Number of nodes in the graph.
+    [[nodiscard]] size_t size() const;
+
+    /// Leaves changed in the last recompute().
+    [[nodiscard]] size_t changedLeaves() const;
+
+private:
+    Vector _roots;
+    /// Nodes in topological order, parents first.
+    std::vector<ValueData *> _nodes;
+    /// Data of every node as of the last recompute().
+    std::vector<DataType> _snapshot;
+    /// Indices of the leaves.
+    std::vector<size_t> _leaves;
+    /// Children of node i are _children[_childBegin[i] .. _childBegin[i + 1]).
+    std::vector<size_t> _childBegin;
+    std::vector<size_t> _children;
+    /// Parents of node i are _parents[_parentBegin[i] .. _parentBegin[i + 1]).
+    std::vector<size_t> _parentBegin;
+    std::vector<size_t> _parents;
+    std::vector<size_t> _rootIndices;
+    /// Leaves changed in the last recompute().
+    std::vector<size_t> _changed;
+    /// Scratch marks, one per node, all false between calls.
+    std::vector<bool> _mark;
+};
+
 std::ostream &operator<<(std::ostream &out, const Value &val);
 #endif //MICROGRAD_ENGINE_H
@@ -0,0 +1,341 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include "graph.h"
+
+namespace {
+    bool isConst(const std::vector<Instr> &nodes, int i, DataType value) {
+        return i >= 0 && nodes[i].op == Op::Const && nodes[i].arg == value;
+    }
+
+    bool hasOperands(Op op) {
+        return op != Op::Leaf && op != Op::Const;
+    }
+
+    DataType apply(Op op, DataType x, DataType y, DataType arg) {
+        switch (op) {
+            case Op::Add:
+                return x + y;
+            case Op::Sub:
+                return x - y;
+            case Op::Mul:
+                return x * y;
+            case Op::Div:
+                return x / y;
+            case Op::Neg:
+                return -x;
+            case Op::Pow:
+                return std::pow(x, arg);
+            case Op::Square:
+                return x * x;
+            case Op::Recip:
+                return 1 / x;
+            case Op::Exp:
+                return std::exp(x);
+            case Op::Relu:
+                return std::max(0.0, x);
+            case Op::Tanh:
+                return std::tanh(x);
+            default:
+                return arg;
+        }
+    }
+
+    /// Point the operands of `n` to their replacements, all of which are final as nodes are visited in order.
+    void remap(Instr &n, const std::vector<int> &replace) {
+        if (n.a >= 0) n.a = replace[n.a];
+        if (n.b >= 0) n.b = replace[n.b];
+    }
+
+    /// Mark the nodes the root depends on.
+    std::vector<bool> live(const std::vector<Instr> &nodes, int root) {
+        std::vector<bool> ret(nodes.size(), false);
+        ret[root] = true;
+        for (int i = root; i >= 0; --i) {
+            if (!ret[i]) continue;
+            if (nodes[i].a >= 0) ret[nodes[i].a] = true;
+            if (nodes[i].b >= 0) ret[nodes[i].b] = true;
+        }
+        return ret;
+    }
+
+    struct InstrHash {
+        size_t operator()(const Instr &n) const {
+            size_t h = std::hash<int>()(int(n.op));
+            h = h * 31 + std::hash<int>()(n.a);
+            h = h * 31 + std::hash<int>()(n.b);
+            return h * 31 + std::hash<uint64_t>()(std::bit_cast<uint64_t>(n.arg));
+        }
+    };
+
+    struct InstrEqual {
+        bool operator()(const Instr &l, const Instr &r) const {
+            return l.op == r.op && l.a == r.a && l.b == r.b &&
+                   std::bit_cast<uint64_t>(l.arg) == std::bit_cast<uint64_t>(r.arg);
+        }
+    };
+}
+
+Graph::Graph(const Value &root, const Vector &variables) {
+    std::unordered_map<ValueData *, int> variableIndex;
+    for (auto &v: variables) {
+        if (variableIndex.try_emplace(v.raw_pointer(), int(_leaves.size())).second) {
+            _leaves.push_back(v.pointer());
+        }
+    }
+
+    // iterative post-order DFS: deep graphs (long sums) would overflow the stack otherwise
+    std::unordered_map<ValueData *, int> index;
+    std::vector<std::pair<ValueData *, size_t>> stack{{root.raw_pointer(), 0}};
+    while (!stack.empty()) {
+        auto &[node, next] = stack.back();
+        if (next < node->prev().size()) {
+            auto child = node->prev()[next++].get();
+            if (!index.contains(child)) stack.emplace_back(child, 0);
+            continue;
+        }
+        if (!index.contains(node)) {
+            Instr n{};
+            auto op = node->op();
+            auto &prev = node->prev();
+            if (prev.empty()) {
+                auto it = variableIndex.find(node);
+                n = it != variableIndex.end() ? Instr{Op::Leaf, -1, -1, DataType(it->second)}
+                                              : Instr{Op::Const, -1, -1, node->data()};
+            } else {
+                static const std::unordered_map<std::string, Op> ops = {
+                        {"+",     Op::Add},
+                        {"-",     Op::Sub},
+                        {"*",     Op::Mul},
+                        {"neg",   Op::Neg},
+                        {"power", Op::Pow},
+                        {"exp",   Op::Exp},
+                        {"relu",  Op::Relu},
+                        {"tanh",  Op::Tanh},
+                };
+                auto it = ops.find(op);
+                if (it == ops.end()) {
+                    throw std::invalid_argument("Graph: unsupported op " + op);
+                }
+                n.op = it->second;
+                n.a = index.at(prev[0].get());
+                n.b = prev.size() > 1 ? index.at(prev[1].get()) : -1;
+                n.arg = node->arg();
+            }
+            index.emplace(node, int(_nodes.size()));
+            _nodes.push_back(n);
+        }
+        stack.pop_back();
+    }
+    _root = index.at(root.raw_pointer());
+}
+
+DataType Graph::forward() {
+    _values.resize(_nodes.size());
+    for (int i = 0; i <= _root; ++i) {
+        auto &n = _nodes[i];
+        if (n.op == Op::Leaf) {
+            _values[i] = _leaves[int(n.arg)]->data();
+        } else {
+            _values[i] = apply(n.op, n.a >= 0 ? _values[n.a] : 0, n.b >= 0 ? _values[n.b] : 0, n.arg);
+        }
+    }
+    return _values[_root];
+}
+
+void Graph::backward() {
+    _grads.assign(_nodes.size(), 0);
+    _grads[_root] = 1;
+    for (int i = _root; i >= 0; --i) {
+        auto &n = _nodes[i];
+        DataType g = _grads[i];
+        if (g == 0) continue;
+        DataType x = n.a >= 0 ? _values[n.a] : 0;
+        DataType y = n.b >= 0 ? _values[n.b] : 0;
+        switch (n.op) {
+            case Op::Leaf:
+                _leaves[int(n.arg)]->grad() += g;
+                break;
+            case Op::Const:
+                break;
+            case Op::Add:
+                _grads[n.a] += g;
+                _grads[n.b] += g;
+                break;
+            case Op::Sub:
+                _grads[n.a] += g;
+                _grads[n.b] -= g;
+                break;
+            case Op::Mul:
+                _grads[n.a] += g * y;
+                _grads[n.b] += g * x;
+                break;
+            case Op::Div:
+                _grads[n.a] += g / y;
+                _grads[n.b] -= g * x / (y * y);
+                break;
+            case Op::Neg:
+                _grads[n.a] -= g;
+                break;
+            case Op::Pow:
+                _grads[n.a] += g * n.arg * std::pow(x, n.arg - 1);
+                break;
+            case Op::Square:
+                _grads[n.a] += 2 * g * x;
+                break;
+            case Op::Recip:
+                _grads[n.a] -= g / (x * x);
+                break;
+            case Op::Exp:
+                _grads[n.a] += g * _values[i];
+                break;
+            case Op::Relu:
+                _grads[n.a] += _values[i] > 0 ? g : 0;
+                break;
+            case Op::Tanh:
+                _grads[n.a] += g * (1 - _values[i] * _values[i]);
+                break;
+        }
+    }
+}
+
+size_t Graph::size() const {
+    return _nodes.size();
+}
+
+size_t Graph::liveSize() const {
+    auto l = live(_nodes, _root);
+    return std::count(l.begin(), l.end(), true);
+}
+
+PassReport Graph::eliminateCommonSubexpressions() {
+    PassReport report{"common subexpression elimination"};
+    auto before = liveSize();
+    std::vector<int> replace(_nodes.size());
+    std::unordered_map<Instr, int, InstrHash, InstrEqual> seen;
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        auto &n = _nodes[i];
+        remap(n, replace);
+        auto key = n;
+        if ((key.op == Op::Add || key.op == Op::Mul) && key.a > key.b) std::swap(key.a, key.b);
+        auto [it, inserted] = seen.try_emplace(key, int(i));
+        replace[i] = it->second;
+        report.rewritten += !inserted;
+    }
+    _root = replace[_root];
+    report.removed = before - liveSize();
+    return report;
+}
+
+PassReport Graph::foldConstants() {
+    PassReport report{"constant folding"};
+    auto before = liveSize();
+    for (auto &n: _nodes) {
+        if (!hasOperands(n.op)) continue;
+        bool constant = _nodes[n.a].op == Op::Const && (n.b < 0 || _nodes[n.b].op == Op::Const);
+        if (constant) {
+            auto value = apply(n.op, _nodes[n.a].arg, n.b >= 0 ? _nodes[n.b].arg : 0, n.arg);
+            n = Instr{Op::Const, -1, -1, value};
+            ++report.rewritten;
+        }
+    }
+    report.removed = before - liveSize();
+    return report;
+}
+
+PassReport Graph::removeIdentities() {
+    PassReport report{"identity removal"};
+    auto before = liveSize();
+    std::vector<int> replace(_nodes.size());
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        auto &n = _nodes[i];
+        remap(n, replace);
+        replace[i] = int(i);
+        if ((n.op == Op::Add && isConst(_nodes, n.b, 0)) || (n.op == Op::Sub && isConst(_nodes, n.b, 0)) ||
+            (n.op == Op::Mul && isConst(_nodes, n.b, 1)) || (n.op == Op::Div && isConst(_nodes, n.b, 1)) ||
+            (n.op == Op::Pow && n.arg == 1)) {
+            replace[i] = n.a;
+        } else if ((n.op == Op::Add && isConst(_nodes, n.a, 0)) || (n.op == Op::Mul && isConst(_nodes, n.a, 1))) {
+            replace[i] = n.b;
+        } else if (n.op == Op::Neg && _nodes[n.a].op == Op::Neg) {
+            replace[i] = _nodes[n.a].a;
+        }
+        report.rewritten += replace[i] != int(i);
+    }
+    _root = replace[_root];
+    report.removed = before - liveSize();
+    return report;
+}
+
+PassReport Graph::reduceStrength() {
+    PassReport report{"strength reduction"};
+    auto before = liveSize();
+    for (auto &n: _nodes) {
+        if (n.op == Op::Pow && n.arg == 2) {
+            n = Instr{Op::Square, n.a};
+        } else if (n.op == Op::Pow && n.arg == -1) {
+            n = Instr{Op::Recip, n.a};
+        } else if (n.op == Op::Mul && n.a == n.b) {
+            n = Instr{Op::Square, n.a};
+        } else if (n.op == Op::Mul && _nodes[n.b].op == Op::Recip) {
+            n = Instr{Op::Div, n.a, _nodes[n.b].a};
+        } else if (n.op == Op::Mul && _nodes[n.a].op == Op::Recip) {
+            n = Instr{Op::Div, n.b, _nodes[n.a].a};
+        } else {
+            continue;
+        }
+        ++report.rewritten;
+    }
+    report.removed = before - liveSize();
+    return report;
+}
+
+PassReport Graph::eliminateDeadNodes() {
+    PassReport report{"dead-node elimination"};
+    auto l = live(_nodes, _root);
+    std::vector<int> replace(_nodes.size(), -1);
+    std::vector<int> leafIndex(_leaves.size(), -1);
+    std::vector<Instr> nodes;
+    std::vector<ValueDataPtr> leaves;
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        if (!l[i]) continue;
+        auto n = _nodes[i];
+        remap(n, replace);
+        if (n.op == Op::Leaf) {
+            auto &idx = leafIndex[int(n.arg)];
+            if (idx < 0) {
+                idx = int(leaves.size());
+                leaves.push_back(_leaves[int(n.arg)]);
+            }
+            n.arg = idx;
+        }
+        replace[i] = int(nodes.size());
+        nodes.push_back(n);
+    }
+    report.removed = _nodes.size() - nodes.size();
+    _root = replace[_root];
+    _nodes = std::move(nodes);
+    _leaves = std::move(leaves);
+    return report;
+}
+
+std::vector<PassReport> Graph::optimize() {
+    std::vector<PassReport> ret;
+    ret.push_back(foldConstants());
+    ret.push_back(removeIdentities());
+    ret.push_back(reduceStrength());
+    ret.push_back(eliminateCommonSubexpressions());
+    ret.push_back(eliminateDeadNodes());
+    return ret;
+}
+
+std::ostream &operator<<(std::ostream &out, const PassReport &report) {
+    out << report.name << ": removed " << report.removed << " nodes, rewrote " << report.rewritten;
+    return out;
+}
@@ -0,0 +1,97 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_GRAPH_H
+#define MICROGRAD_GRAPH_H
+
+#include "engine.h"
+
+/// Operations of a captured graph.
+enum class Op {
+    Leaf,
+    Const,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Pow,
+    Square,
+    Recip,
+    Exp,
+    Relu,
+    Tanh,
+};
+
+/// A node of a captured graph, operands are indices of earlier nodes.
+struct Instr {
+    Op op;
+    int a = -1;
+    int b = -1;
+    /// Constant value, exponent of Pow, or index of the leaf for Leaf.
+    DataType arg = 0;
+};
+
+/// Outcome of an optimization pass.
+struct PassReport {
+    std::string name;
+    /// Nodes no longer needed to compute the root after the pass
+    /// (for dead-node elimination: nodes dropped from the graph).
+    size_t removed = 0;
+    /// Nodes rewritten to a cheaper op or replaced by another node.
+    size_t rewritten = 0;
+};
+
+/**
+ * An expression graph captured from a Value as a flat list of nodes in topological order,
+ * for graphs that are executed many times (e.g. one training step with different parameters).
+ *
+ * Leaves listed as variables are read on every forward() and receive grads in backward(),
+ * every other leaf is captured as a constant.
+ */
+class Graph {
+public:
+    Graph(const Value &root, const Vector &variables);
+
+    /// Evaluate the graph with the current data of the variables, returns the root value.
+    DataType forward();
+
+    /// Accumulate d(root)/d(variable) into the grad of each variable, requires a forward() first.
+    void backward();
+
+    /// Number of nodes in the graph.
+    [[nodiscard]] size_t size() const;
+
+    /// Number of nodes the root depends on.
+    [[nodiscard]] size_t liveSize() const;
+
+    /// Replace nodes with identical op and operands (operands in any order for + and *) by a single one.
+    PassReport eliminateCommonSubexpressions();
+
+    /// Evaluate nodes whose operands are all constants.
+    PassReport foldConstants();
+
+    /// Remove x + 0, x - 0, x * 1, x / 1, x ^ 1 and -(-x).
+    PassReport removeIdentities();
+
+    /// x ^ 2 and x * x to square, x ^ -1 to reciprocal, x * (1 / y) to division.
+    PassReport reduceStrength();
+
+    /// Drop nodes the root does not depend on.
+    PassReport eliminateDeadNodes();
+
+    /// Run constant folding, identity removal, strength reduction, CSE and finally dead-node elimination.
+    std::vector<PassReport> optimize();
+
+private:
+    std::vector<Instr> _nodes;
+    int _root = -1;
+    std::vector<ValueDataPtr> _leaves;
+    std::vector<DataType> _values;
+    std::vector<DataType> _grads;
+};
+
+std::ostream &operator<<(std::ostream &out, const PassReport &report);
+
+#endif //MICROGRAD_GRAPH_H
@@ -0,0 +1,84 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "engine.h"
+#include "neuronet.h"
+#include "dataset.h"
+#include "graph.h"
+#include "loss.h"
+
+using Clock = std::chrono::steady_clock;
+
+/// Average ms of a forward + backward on the captured graph.
+double timeStep(Graph graph, int repeat) {
+    auto t0 = Clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        graph.forward();
+        graph.backward();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / repeat;
+}
+
+/// Apply the optimization passes one by one on the demo training step and report what each of them saves.
+int main() {
+    auto data = Dataset::read("data/moonX.csv", "data/moonY.csv");
+    if (data.X.size() != data.y.size()) {
+        std::cout << "X and y have different sizes.";
+        exit(1);
+    }
+    auto X = data.values();
+
+    MLP model(2, {16, 16, 1});
+    auto params = model.parameters();
+    int repeat = 20;
+    int graphRepeat = 500;
+
+    auto t0 = Clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        demo_loss(model, X, data.y).backward();
+    }
+    auto rebuild = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / repeat;
+    std::cout << "rebuild graph + backward: " << rebuild << "ms/step\n";
+
+    auto loss = demo_loss(model, X, data.y);
+    Graph graph(loss, params);
+    auto time = timeStep(graph, graphRepeat);
+    std::cout << "captured: " << graph.size() << " nodes, " << time << "ms/step\n";
+
+    std::vector<PassReport (Graph::*)()> passes = {
+            &Graph::foldConstants,
+            &Graph::removeIdentities,
+            &Graph::reduceStrength,
+            &Graph::eliminateCommonSubexpressions,
+            &Graph::eliminateDeadNodes,
+    };
+    for (auto pass: passes) {
+        auto report = (graph.*pass)();
+        // time the graph as if dead nodes were pruned right after this pass
+        Graph pruned = graph;
+        pruned.eliminateDeadNodes();
+        auto t = timeStep(pruned, graphRepeat);
+        std::cout << report << ", " << graph.liveSize() << " nodes left, " << t << "ms/step (saved "
+                  << time - t << "ms)\n";
+        time = t;
+    }
+
+    // the optimized graph computes the same loss and grads
+    for (auto &p: params) p->grad() = 0;
+    loss.backward();
+    std::vector<DataType> expected;
+    for (auto &p: params) {
+        expected.push_back(p->grad());
+        p->grad() = 0;
+    }
+    auto value = graph.forward();
+    graph.backward();
+    DataType maxDiff = 0;
+    for (size_t i = 0; i < params.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(params[i]->grad() - expected[i]));
+    }
+    std::cout << "loss " << loss->data() << " vs " << value << ", max grad difference " << maxDiff << "\n";
+}
@@ -0,0 +1,43 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "neuronet.h"
+#include "threadpool.h"
+
+using Clock = std::chrono::steady_clock;
+
+/// Order-dependent checksum of every parameter.
+DataType checksum(MLP &model) {
+    DataType sum = 0;
+    size_t i = 0;
+    for (auto &p: model.parameters()) {
+        sum += p->data() * DataType(++i % 7 + 1);
+    }
+    return sum;
+}
+
+/// Construction time of 1M and 10M parameter models: the default constructor against block allocation with
+/// the counter-based initializer on one thread and on every core.
+int main() {
+    ThreadPool pool;
+    for (int layers: {1, 10}) {
+        // layers of 1000 x 1000: about 1M parameters each
+        std::vector<int> nOuts(layers, 1000);
+        auto time = [](auto build) {
+            auto t0 = Clock::now();
+            MLP model = build();
+            auto seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+            return std::make_pair(seconds, checksum(model));
+        };
+
+        auto legacy = time([&] { return MLP(1000, nOuts); });
+        auto serial = time([&] { return MLP(1000, nOuts, InitOptions{42, Init::Xavier}); });
+        auto parallel = time([&] { return MLP(1000, nOuts, InitOptions{42, Init::Xavier, &pool}); });
+        std::cout << layers * 1001000 << " parameters: default " << legacy.first << "s, block " << serial.first
+                  << "s, block on " << pool.size() << " threads " << parallel.first << "s, identical "
+                  << (serial.second == parallel.second ? "yes" : "no") << "\n";
+    }
+}
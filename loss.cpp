@@ -0,0 +1,156 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include "loss.h"
+
+namespace {
+    ValueData::Prev pointers(const Vector &values) {
+        ValueData::Prev ret;
+        ret.reserve(values.size());
+        for (auto &v: values) {
+            ret.push_back(v.pointer());
+        }
+        return ret;
+    }
+
+    /// Copy the data of the parents into a contiguous buffer.
+    std::vector<DataType> gather(const ValueData::Prev &prev) {
+        std::vector<DataType> ret(prev.size());
+        for (size_t i = 0; i < prev.size(); ++i) {
+            ret[i] = prev[i]->data();
+        }
+        return ret;
+    }
+
+    /// Computes the loss from the contiguous data of the parents and writes d(loss)/d(parent i) into grads[i].
+    using Evaluate = std::function<DataType(const std::vector<DataType> &data, std::vector<DataType> &grads)>;
+
+    /// A single node over the whole batch: the forward pass computes the value and the local grads together and
+    /// caches the grads, the backward pass only scales them by the grad of the node.
+    Value fused(const std::string &op, const Vector &inputs, Evaluate evaluate) {
+        auto x = Value(0, op, pointers(inputs));
+        auto grads = std::make_shared<std::vector<DataType>>(inputs.size());
+        x->forward([out = x.raw_pointer(), grads, evaluate = std::move(evaluate)] {
+            out->data() = evaluate(gather(out->prev()), *grads);
+        });
+        x << [out = x.raw_pointer(), grads] {
+            auto &prev = out->prev();
+            for (size_t i = 0; i < prev.size(); ++i) {
+                prev[i]->grad() += out->grad() * (*grads)[i];
+            }
+        };
+        x->forward();
+        return x;
+    }
+
+    void checkSizes(const char *function, size_t values, size_t labels) {
+        if (values != labels) {
+            throw std::invalid_argument(std::string(function) + ": " + std::to_string(values) + " values but " +
+                                        std::to_string(labels) + " labels");
+        }
+    }
+}
+
+Value hinge_loss(const Vector &scores, const std::vector<DataType> &labels) {
+    checkSizes("hinge_loss", scores.size(), labels.size());
+    return fused("hinge", scores, [labels](const std::vector<DataType> &s, std::vector<DataType> &grads) {
+        DataType n = DataType(s.size());
+        DataType sum = 0;
+        for (size_t i = 0; i < s.size(); ++i) {
+            DataType margin = 1 - labels[i] * s[i];
+            sum += std::max(0.0, margin);
+            grads[i] = margin > 0 ? -labels[i] / n : 0;
+        }
+        return s.empty() ? 0 : sum / n;
+    });
+}
+
+Value mse_loss(const Vector &preds, const std::vector<DataType> &targets) {
+    checkSizes("mse_loss", preds.size(), targets.size());
+    return fused("mse", preds, [targets](const std::vector<DataType> &p, std::vector<DataType> &grads) {
+        DataType n = DataType(p.size());
+        DataType sum = 0;
+        for (size_t i = 0; i < p.size(); ++i) {
+            DataType diff = p[i] - targets[i];
+            sum += diff * diff;
+            grads[i] = 2 * diff / n;
+        }
+        return p.empty() ? 0 : sum / n;
+    });
+}
+
+Value softmax_cross_entropy(const Vector2D &logits, const std::vector<int> &labels) {
+    size_t rows = logits.size();
+    size_t cols = rows ? logits.front().size() : 0;
+    checkSizes("softmax_cross_entropy", rows, labels.size());
+    if (rows && cols == 0) {
+        throw std::invalid_argument("softmax_cross_entropy: rows have no logits");
+    }
+    Vector flat;
+    flat.reserve(rows * cols);
+    for (size_t r = 0; r < rows; ++r) {
+        if (logits[r].size() != cols) {
+            throw std::invalid_argument("softmax_cross_entropy: row " + std::to_string(r) + " has " +
+                                        std::to_string(logits[r].size()) + " logits, expected " +
+                                        std::to_string(cols));
+        }
+        if (labels[r] < 0 || size_t(labels[r]) >= cols) {
+            throw std::invalid_argument("softmax_cross_entropy: label " + std::to_string(labels[r]) + " of row " +
+                                        std::to_string(r) + " is not a class index");
+        }
+        flat.append_range(logits[r]);
+    }
+
+    return fused("softmax_xent", flat, [labels, rows, cols](const std::vector<DataType> &z,
+                                                            std::vector<DataType> &grads) {
+        DataType sum = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            auto row = z.data() + r * cols;
+            auto g = grads.data() + r * cols;
+            // shift by the row max so that exp does not overflow, the exps are kept for the grads
+            DataType m = *std::max_element(row, row + cols);
+            DataType total = 0;
+            for (size_t c = 0; c < cols; ++c) {
+                g[c] = std::exp(row[c] - m);
+                total += g[c];
+            }
+            sum += m + std::log(total) - row[labels[r]];
+            // d/dz = (softmax(z) - onehot(label)) / rows
+            for (size_t c = 0; c < cols; ++c) {
+                g[c] = (g[c] / total - (int(c) == labels[r] ? 1 : 0)) / DataType(rows);
+            }
+        }
+        return rows ? sum / rows : 0;
+    });
+}
+
+Value hinge_loss_composed(const Vector &scores, const std::vector<DataType> &labels) {
+    checkSizes("hinge_loss_composed", scores.size(), labels.size());
+    if (scores.empty()) return Value(0);
+    Vector losses;
+    losses.reserve(scores.size());
+    for (size_t i = 0; i < scores.size(); ++i) {
+        losses.push_back((1 - labels[i] * scores[i]).relu());
+    }
+    return std::accumulate(losses.begin(), losses.end(), Value(0)) / DataType(scores.size());
+}
+
+Value l2_loss(const Vector &params) {
+    return std::accumulate(params.begin(), params.end(), Value(0), [](const Value &l, const Value &r) {
+        return l + r * r;
+    });
+}
+
+Value demo_loss(MLP &model, const Vector2D &X, const std::vector<DataType> &y, DataType alpha) {
+    Vector scores;
+    scores.reserve(X.size());
+    for (auto &x: X) {
+        scores.push_back(model(x)[0]);
+    }
+    return hinge_loss_composed(scores, y) + alpha * l2_loss(model.parameters());
+}
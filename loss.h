@@ -0,0 +1,41 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_LOSS_H
+#define MICROGRAD_LOSS_H
+
+#include "engine.h"
+#include "neuronet.h"
+
+/*
+ * Batched losses as a single node: the forward value and the grads of the whole batch are computed in one pass
+ * over contiguous arrays, instead of a handful of scalar nodes per sample. The grads are cached by the forward pass,
+ * backward only scales them.
+ * These nodes have one parent per sample, which Graph does not capture (it throws std::invalid_argument): losses to
+ * be captured are built with hinge_loss_composed / demo_loss instead.
+ * Inputs are checked: mismatched sizes, ragged logits or class indices out of range throw std::invalid_argument.
+ */
+
+/// Mean max-margin loss: mean(relu(1 - label_i * score_i)), labels are -1/1.
+Value hinge_loss(const Vector &scores, const std::vector<DataType> &labels);
+
+/// Mean squared error: mean((pred_i - target_i)^2).
+Value mse_loss(const Vector &preds, const std::vector<DataType> &targets);
+
+/// Mean softmax cross-entropy of one row of logits per sample against class indices,
+/// computed with a log-sum-exp shifted by the row max so that large logits do not overflow.
+Value softmax_cross_entropy(const Vector2D &logits, const std::vector<int> &labels);
+
+/// mean(relu(1 - label_i * score_i)) built from scalar nodes, a few per sample: slower than hinge_loss, but made of
+/// basic ops only, so that Graph can capture it.
+Value hinge_loss_composed(const Vector &scores, const std::vector<DataType> &labels);
+
+/// Sum of the squared parameters.
+Value l2_loss(const Vector &params);
+
+/// The training loss of demo.cpp: hinge loss of the first output of `model` on every sample (labels are -1/1),
+/// plus alpha * l2_loss of its parameters. Built with hinge_loss_composed, so that Graph can capture it.
+Value demo_loss(MLP &model, const Vector2D &X, const std::vector<DataType> &y, DataType alpha = 1e-4);
+
+#endif //MICROGRAD_LOSS_H
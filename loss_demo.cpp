@@ -0,0 +1,107 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include <numbers>
+#include "engine.h"
+#include "neuronet.h"
+#include "dataset.h"
+#include "loss.h"
+
+using Clock = std::chrono::steady_clock;
+
+/// `classes` gaussian blobs of `n` points each, centered on the unit circle.
+void blobs(int n, int classes, Vector2D &X, std::vector<int> &labels) {
+    std::mt19937 gen(7);
+    std::normal_distribution<DataType> noise(0, 0.3);
+    for (int c = 0; c < classes; ++c) {
+        DataType t = c * 2 * std::numbers::pi / classes;
+        for (int i = 0; i < n; ++i) {
+            X.push_back({Value(std::cos(t) + noise(gen)), Value(std::sin(t) + noise(gen))});
+            labels.push_back(c);
+        }
+    }
+}
+
+/// Compare the fused hinge loss with the per-sample graph of demo.cpp, then train a 3-class classifier with
+/// softmax cross-entropy.
+int main() {
+    auto data = Dataset::read("data/moonX.csv", "data/moonY.csv");
+    if (data.X.size() != data.y.size()) {
+        std::cout << "X and y have different sizes.";
+        exit(1);
+    }
+    auto X = data.values();
+    int N = X.size();
+    std::mt19937 gen(1);
+    MLP model(2, {16, 16, 1}, gen);
+    auto params = model.parameters();
+    Vector scores;
+    for (auto &x: X) {
+        scores.push_back(model(x)[0]);
+    }
+
+    int repeat = 200;
+    auto t0 = Clock::now();
+    Value composed;
+    for (int r = 0; r < repeat; ++r) {
+        composed = hinge_loss_composed(scores, data.y);
+    }
+    auto t1 = Clock::now();
+    Value fused;
+    for (int r = 0; r < repeat; ++r) {
+        fused = hinge_loss(scores, data.y);
+    }
+    auto t2 = Clock::now();
+    auto us = [&](auto d) { return std::chrono::duration<double, std::micro>(d).count() / repeat; };
+    std::cout << "hinge over " << N << " samples: composed " << composed->data() << " in " << us(t1 - t0)
+              << "us, fused " << fused->data() << " in " << us(t2 - t1) << "us\n";
+
+    composed.backward();
+    std::vector<DataType> expected;
+    for (auto &p: params) {
+        expected.push_back(p->grad());
+        p->grad() = 0;
+    }
+    fused.backward();
+    DataType maxDiff = 0;
+    for (size_t i = 0; i < params.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(params[i]->grad() - expected[i]));
+        params[i]->grad() = 0;
+    }
+    std::cout << "max grad difference " << maxDiff << "\n";
+
+    Vector2D blobX;
+    std::vector<int> labels;
+    blobs(40, 3, blobX, labels);
+    MLP classifier(2, {16, 16, 3}, gen);
+    auto classifierParams = classifier.parameters();
+    int n = 100;
+    for (int k = 0; k < n; ++k) {
+        Vector2D logits;
+        double accuracy = 0;
+        for (size_t i = 0; i < blobX.size(); ++i) {
+            // outputs are tanh'ed by the neurons, scale them up so that softmax can get confident
+            auto out = classifier(blobX[i]);
+            for (auto &o: out) o = o * 4.0;
+            auto best = std::max_element(out.begin(), out.end(), [](const Value &l, const Value &r) {
+                return l->data() < r->data();
+            });
+            accuracy += (best - out.begin()) == labels[i];
+            logits.push_back(std::move(out));
+        }
+        accuracy /= blobX.size();
+        auto loss = softmax_cross_entropy(logits, labels);
+        loss.backward();
+        double learningRate = 0.5 * (1.0 - 0.9 * k / n);
+        for (auto &p: classifierParams) {
+            p->data() -= learningRate * p->grad();
+            p->grad() = 0;
+        }
+        if (k % 10 == 0 || k == n - 1) {
+            std::cout << "step " << k << " loss " << loss->data() << ", accuracy " << accuracy * 100 << "%\n";
+        }
+    }
+}
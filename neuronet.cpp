@@ -2,30 +2,55 @@
 // Created by Xiaofeng Li on 18/9/2024.
 //
 
+#include <cmath>
 #include "neuronet.h"
+#include "threadpool.h"
 
+/// Generator shared by models built without an explicit one, seeded randomly.
+static std::mt19937 &generator() {
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    return gen;
+}
 
 /// Generate uniform random value in range [left, right]
 /// \param left
 /// \param right
 /// \return
 DataType uniform(DataType left, DataType right) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+    return uniform(left, right, generator());
+}
+
+DataType uniform(DataType left, DataType right, std::mt19937 &gen) {
     std::uniform_real_distribution<> dis(left, right);
     return dis(gen);
 }
 
+DataType counter_uniform(uint64_t seed, uint64_t counter, DataType left, DataType right) {
+    // splitmix64 finalizer over the counter, keyed by the mixed seed
+    auto mix = [](uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+    uint64_t z = mix(counter * 0x9e3779b97f4a7c15ULL + mix(seed + 0x9e3779b97f4a7c15ULL));
+    return left + (right - left) * DataType(z >> 11) * 0x1.0p-53;
+}
+
 
 /**
  * A neuron has n inputs and one output.
  */
-Neuron::Neuron(int nIn) : _w(nIn), _b(uniform(-1, 1)) {
+Neuron::Neuron(int nIn) : Neuron(nIn, generator()) {}
+
+Neuron::Neuron(int nIn, std::mt19937 &gen) : _w(nIn), _b(uniform(-1, 1, gen)) {
     for (int i = 0; i < nIn; ++i) {
-        _w[i] = Value(uniform(-1, 1));
+        _w[i] = Value(uniform(-1, 1, gen));
     }
 }
 
+Neuron::Neuron(Vector w, Value b) : _w(std::move(w)), _b(std::move(b)) {}
+
 Value Neuron::operator()(const std::vector<Value> &x) {
     // w * x + b
     Value r = _b;
@@ -42,9 +67,19 @@ std::vector<Value> Neuron::parameters() {
     return ret;
 }
 
-Layer::Layer(int nIn, int nOut) {
+const Vector &Neuron::weights() const {
+    return _w;
+}
+
+const Value &Neuron::bias() const {
+    return _b;
+}
+
+Layer::Layer(int nIn, int nOut) : Layer(nIn, nOut, generator()) {}
+
+Layer::Layer(int nIn, int nOut, std::mt19937 &gen) {
     for (int i = 0; i < nOut; ++i) {
-        _neurons.emplace_back(nIn);
+        _neurons.emplace_back(nIn, gen);
     }
 }
 
@@ -65,13 +100,67 @@ std::vector<Value> Layer::parameters() {
     return ret;
 }
 
-MLP::MLP(int nIn, const std::vector<int> &nOuts) {
+Layer::Layer(int nIn, int nOut, const InitOptions &options, uint64_t first) {
+    size_t perNeuron = nIn + 1;
+    size_t n = nOut * perNeuron;
+    DataType limit = 1;
+    if (options.init == Init::Xavier) {
+        limit = std::sqrt(6.0 / (nIn + nOut));
+    } else if (options.init == Init::He) {
+        limit = std::sqrt(6.0 / nIn);
+    }
+
+    ValueData *block = std::allocator<ValueData>().allocate(n);
+    parallel_for(options.pool, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            bool bias = i % perNeuron == size_t(nIn);
+            DataType v = 0;
+            if (!bias || options.init == Init::Uniform) {
+                v = counter_uniform(options.seed, first + i, -limit, limit);
+            }
+            std::construct_at(block + i, v);
+        }
+    });
+    // one control block owns the whole layer, every parameter aliases it
+    ValueDataPtr owner(block, [n](ValueData *p) {
+        std::destroy_n(p, n);
+        std::allocator<ValueData>().deallocate(p, n);
+    });
+
+    _neurons.reserve(nOut);
+    for (int j = 0; j < nOut; ++j) {
+        auto row = block + j * perNeuron;
+        Vector w;
+        w.reserve(nIn);
+        for (int i = 0; i < nIn; ++i) {
+            w.emplace_back(ValueDataPtr(owner, row + i));
+        }
+        _neurons.emplace_back(std::move(w), Value(ValueDataPtr(owner, row + nIn)));
+    }
+}
+
+const std::vector<Neuron> &Layer::neurons() const {
+    return _neurons;
+}
+
+MLP::MLP(int nIn, const std::vector<int> &nOuts) : MLP(nIn, nOuts, generator()) {}
+
+MLP::MLP(int nIn, const std::vector<int> &nOuts, std::mt19937 &gen) {
     std::vector<int> sz;
     sz.reserve(1 + nOuts.size());
     sz.push_back(nIn);
     sz.insert(sz.end(), nOuts.begin(), nOuts.end());
     for (int i = 0; i < nOuts.size(); ++i) {
-        _layers.emplace_back(sz[i], sz[i + 1]);
+        _layers.emplace_back(sz[i], sz[i + 1], gen);
+    }
+}
+
+MLP::MLP(int nIn, const std::vector<int> &nOuts, const InitOptions &options) {
+    uint64_t first = 0;
+    for (auto nOut: nOuts) {
+        _layers.emplace_back(nIn, nOut, options, first);
+        first += uint64_t(nOut) * (nIn + 1);
+        nIn = nOut;
     }
 }
 
@@ -90,3 +179,11 @@ std::vector<Value> MLP::parameters() {
     }
     return ret;
 }
+
+const std::vector<Layer> &MLP::layers() const {
+    return _layers;
+}
+
+std::vector<Layer> &MLP::layers() {
+    return _layers;
+}
@@ -5,6 +5,7 @@
 #ifndef MICROGRAD_NEURONET_H
 #define MICROGRAD_NEURONET_H
 
+#include <cstdint>
 #include "engine.h"
 
 /// Generate uniform random value in range [left, right]
@@ -13,6 +14,32 @@
 /// \return
 DataType uniform(DataType left, DataType right);
 
+/// Generate uniform random value in range [left, right] from the given generator
+DataType uniform(DataType left, DataType right, std::mt19937 &gen);
+
+/// Counter-based uniform random value in range [left, right): a pure function of (seed, counter),
+/// so values do not depend on which thread generates them or in which order.
+DataType counter_uniform(uint64_t seed, uint64_t counter, DataType left, DataType right);
+
+class ThreadPool;
+
+/// Weight initialization schemes, weights are drawn uniformly from [-limit, limit].
+enum class Init {
+    /// limit = 1, biases from the same range (what the default constructors do).
+    Uniform,
+    /// limit = sqrt(6 / (nIn + nOut)), zero biases, suited for tanh.
+    Xavier,
+    /// limit = sqrt(6 / nIn), zero biases, suited for relu.
+    He,
+};
+
+struct InitOptions {
+    uint64_t seed = 0;
+    Init init = Init::Uniform;
+    /// Pool to initialize parameters on, null to use the calling thread.
+    ThreadPool *pool = nullptr;
+};
+
 /**
  * A neuron has n inputs and one output.
  */
@@ -20,10 +47,20 @@ class Neuron {
 public:
     explicit Neuron(int nIn);
 
+    Neuron(int nIn, std::mt19937 &gen);
+
+    Neuron(Vector w, Value b);
+
     Value operator()(const Vector &x);
 
     Vector parameters();
 
+    /// Input weights of the neuron.
+    [[nodiscard]] const Vector &weights() const;
+
+    /// Bias of the neuron.
+    [[nodiscard]] const Value &bias() const;
+
 private:
     Vector _w;
     Value _b;
@@ -33,10 +70,18 @@ class Layer {
 public:
     Layer(int nIn, int nOut);
 
+    Layer(int nIn, int nOut, std::mt19937 &gen);
+
+    /// All parameters of the layer are allocated in one block and initialized in parallel.
+    /// \param first index of the layer's first parameter in the model, offsets the RNG counter
+    Layer(int nIn, int nOut, const InitOptions &options, uint64_t first = 0);
+
     Vector operator()(const Vector &x);
 
     Vector parameters();
 
+    [[nodiscard]] const std::vector<Neuron> &neurons() const;
+
 private:
     std::vector<Neuron> _neurons;
 };
@@ -45,10 +90,21 @@ class MLP {
 public:
     MLP(int nIn, const std::vector<int> &nOuts);
 
+    /// Initialize the weights from `gen`, e.g. a generator with a fixed seed for reproducible runs.
+    MLP(int nIn, const std::vector<int> &nOuts, std::mt19937 &gen);
+
+    /// Fast construction of large models: one block of parameters per layer, initialized in parallel with a
+    /// counter-based RNG, the result only depends on the seed (not on the number of threads).
+    MLP(int nIn, const std::vector<int> &nOuts, const InitOptions &options);
+
     Vector operator()(const Vector &x);
 
     Vector parameters();
 
+    [[nodiscard]] const std::vector<Layer> &layers() const;
+
+    std::vector<Layer> &layers();
+
 private:
     std::vector<Layer> _layers;
 };
@@ -0,0 +1,221 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include "pipeline.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /// Activations (or their grads) of one microbatch, one row per sample.
+    using Rows = std::vector<std::vector<DataType>>;
+
+    template<typename T>
+    void pushWait(SpscQueue<T> &queue, T value) {
+        while (!queue.push(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    template<typename T>
+    T popWait(SpscQueue<T> &queue) {
+        T value;
+        while (!queue.pop(value)) {
+            std::this_thread::yield();
+        }
+        return value;
+    }
+
+    /// Graph of one microbatch kept by a stage between its forward and its backward.
+    struct Microbatch {
+        Vector2D inputs;
+        /// Outputs of every sample, flattened, or the loss on the last stage.
+        Vector outputs;
+    };
+}
+
+Pipeline::Pipeline(MLP &model, int stages) : _model(model) {
+    auto &layers = model.layers();
+    if (layers.empty()) {
+        throw std::invalid_argument("Pipeline: model has no layers");
+    }
+    for (auto &layer: layers) {
+        if (layer.neurons().empty()) {
+            throw std::invalid_argument("Pipeline: model has an empty layer");
+        }
+    }
+    if (layers.back().neurons().size() != 1) {
+        throw std::invalid_argument("Pipeline: the last layer must have a single output, one score per label");
+    }
+    int L = int(layers.size());
+    int P = std::clamp(stages, 1, L);
+    std::vector<double> weights;
+    double total = 0;
+    for (auto &layer: layers) {
+        auto &neurons = layer.neurons();
+        weights.push_back(double(neurons.size()) * (neurons.front().weights().size() + 1));
+        total += weights.back();
+    }
+
+    int first = 0;
+    double acc = 0;
+    for (int s = 0; s < P; ++s) {
+        int last = first + 1;
+        acc += weights[first];
+        // grow the stage while that brings it closer to its share of the weights,
+        // leaving a layer for each remaining stage
+        double target = total * (s + 1) / P;
+        while (last < L - (P - s - 1) && std::abs(acc + weights[last] - target) < std::abs(acc - target)) {
+            acc += weights[last++];
+        }
+        if (s == P - 1) last = L;
+        _stages.emplace_back(first, last);
+        first = last;
+    }
+}
+
+PipelineStats Pipeline::train(const Dataset &data, int steps, int microbatchSize, DataType learningRate,
+                              DataType alpha) {
+    if (microbatchSize <= 0) {
+        throw std::invalid_argument("Pipeline: microbatchSize must be positive");
+    }
+    if (data.X.size() != data.y.size()) {
+        throw std::invalid_argument("Pipeline: X and y have different sizes");
+    }
+    int P = int(_stages.size());
+    int N = int(data.X.size());
+    int M = (N + microbatchSize - 1) / microbatchSize;
+
+    // activations[s] carries stage s -> s + 1, grads[s] carries stage s + 1 -> s
+    std::vector<std::unique_ptr<SpscQueue<Rows>>> activations, grads;
+    for (int s = 0; s + 1 < P; ++s) {
+        activations.push_back(std::make_unique<SpscQueue<Rows>>(M));
+        grads.push_back(std::make_unique<SpscQueue<Rows>>(M));
+    }
+
+    PipelineStats stats;
+    stats.stages = P;
+    stats.microbatches = M;
+    stats.stageBusy.resize(P);
+
+    auto stage = [&](int s) {
+        auto [firstLayer, lastLayer] = _stages[s];
+        bool isFirst = s == 0, isLast = s == P - 1;
+        auto &layers = _model.layers();
+        Vector params;
+        for (int l = firstLayer; l < lastLayer; ++l) {
+            params.append_range(layers[l].parameters());
+        }
+
+        double busy = 0;
+        for (int k = 0; k < steps; ++k) {
+            std::deque<Microbatch> stash;
+            DataType stepLoss = 0;
+
+            auto forwardStep = [&](int m) {
+                Rows rows = isFirst ? Rows(data.X.begin() + m * microbatchSize,
+                                           data.X.begin() + std::min(N, (m + 1) * microbatchSize))
+                                    : popWait(*activations[s - 1]);
+                auto t0 = Clock::now();
+                Microbatch mb;
+                Rows out;
+                for (auto &row: rows) {
+                    Vector x(row.begin(), row.end());
+                    auto t = x;
+                    for (int l = firstLayer; l < lastLayer; ++l) {
+                        t = layers[l](t);
+                    }
+                    mb.inputs.push_back(std::move(x));
+                    std::vector<DataType> o;
+                    for (auto &v: t) {
+                        o.push_back(v->data());
+                        mb.outputs.push_back(v);
+                    }
+                    out.push_back(std::move(o));
+                }
+                if (isLast) {
+                    // demo.cpp's data loss, the share of this microbatch: one output per sample (checked by the
+                    // constructor)
+                    Value loss(0);
+                    for (size_t i = 0; i < mb.outputs.size(); ++i) {
+                        loss += (1 - data.y[m * microbatchSize + i] * mb.outputs[i]).relu() / N;
+                    }
+                    stepLoss += loss->data();
+                    mb.outputs = {loss};
+                }
+                busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                stash.push_back(std::move(mb));
+                if (!isLast) pushWait(*activations[s], std::move(out));
+            };
+
+            auto backwardStep = [&]() {
+                Rows outGrads = isLast ? Rows() : popWait(*grads[s]);
+                auto t0 = Clock::now();
+                auto mb = std::move(stash.front());
+                stash.pop_front();
+                if (isLast) {
+                    mb.outputs[0].backward();
+                } else {
+                    std::vector<DataType> flat;
+                    for (auto &row: outGrads) flat.append_range(row);
+                    backward(mb.outputs, flat);
+                }
+                Rows inGrads;
+                if (!isFirst) {
+                    for (auto &x: mb.inputs) {
+                        std::vector<DataType> g;
+                        for (auto &v: x) g.push_back(v->grad());
+                        inGrads.push_back(std::move(g));
+                    }
+                }
+                busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                if (!isFirst) pushWait(*grads[s - 1], std::move(inGrads));
+            };
+
+            // 1F1B: fill the pipeline, then alternate one forward and one backward, then drain
+            int warmup = std::min(P - s - 1, M);
+            int forwards = 0;
+            for (; forwards < warmup; ++forwards) forwardStep(forwards);
+            for (; forwards < M; ++forwards) {
+                forwardStep(forwards);
+                backwardStep();
+            }
+            for (int b = 0; b < warmup; ++b) backwardStep();
+
+            auto t0 = Clock::now();
+            double rate = learningRate * (1.0 - 0.9 * k / steps);
+            for (auto &p: params) {
+                p->data() -= rate * (p->grad() + 2 * alpha * p->data());
+                p->grad() = 0;
+            }
+            busy += std::chrono::duration<double>(Clock::now() - t0).count();
+            if (isLast) stats.loss = stepLoss;
+        }
+        stats.stageBusy[s] = busy;
+    };
+
+    auto t0 = Clock::now();
+    std::vector<std::thread> threads;
+    for (int s = 0; s < P; ++s) {
+        threads.emplace_back(stage, s);
+    }
+    for (auto &t: threads) {
+        t.join();
+    }
+    stats.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    double busy = 0;
+    for (auto b: stats.stageBusy) busy += b;
+    stats.bubbleFraction = 1 - busy / (P * stats.seconds);
+    stats.idealBubbleFraction = double(P - 1) / (M + P - 1);
+    stats.samplesPerSecond = double(N) * steps / stats.seconds;
+    return stats;
+}
+
+const std::vector<std::pair<int, int>> &Pipeline::stages() const {
+    return _stages;
+}
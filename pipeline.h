@@ -0,0 +1,92 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_PIPELINE_H
+#define MICROGRAD_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include "dataset.h"
+#include "neuronet.h"
+
+/**
+ * Lock-free ring buffer for exactly one producer thread and one consumer thread.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    /// Capacity is rounded up to a power of two.
+    explicit SpscQueue(size_t capacity) : _buffer(std::bit_ceil(std::max<size_t>(capacity, 2))),
+                                          _mask(_buffer.size() - 1) {}
+
+    /// Returns false, leaving `value` untouched, if the queue is full.
+    bool push(T &&value) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == _buffer.size()) return false;
+        _buffer[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false if the queue is empty.
+    bool pop(T &value) {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        value = std::move(_buffer[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> _buffer;
+    size_t _mask;
+    /// Next slot to pop, written by the consumer only.
+    alignas(64) std::atomic<size_t> _head = 0;
+    /// Next slot to push, written by the producer only.
+    alignas(64) std::atomic<size_t> _tail = 0;
+};
+
+struct PipelineStats {
+    int stages = 0;
+    int microbatches = 0;
+    double seconds = 0;
+    double samplesPerSecond = 0;
+    /// Fraction of stage time spent waiting for activations or grads, measured.
+    double bubbleFraction = 0;
+    /// (stages - 1) / (microbatches + stages - 1), the bubble of an ideal 1F1B schedule.
+    double idealBubbleFraction = 0;
+    /// Loss of the last step.
+    DataType loss = 0;
+    /// Seconds each stage spent computing.
+    std::vector<double> stageBusy;
+};
+
+/**
+ * Layer-wise pipeline parallel training of an MLP: consecutive layers are assigned to a stage, each stage runs on
+ * its own thread and keeps its layers' weights to itself. A step splits the batch into microbatches that flow
+ * through the stages over lock-free queues, forward and backward interleaved in a 1F1B schedule, followed by an
+ * update of every stage's weights (synchronous SGD, same result as training on the whole batch).
+ */
+class Pipeline {
+public:
+    /// Split the layers of `model` into at most `stages` stages, balanced by weight count.
+    /// Throws std::invalid_argument if a layer is empty or the last layer has more than one output.
+    Pipeline(MLP &model, int stages);
+
+    /// Train `steps` steps on the whole dataset (labels -1/1) with the max-margin loss of demo.cpp.
+    /// Throws std::invalid_argument if microbatchSize is not positive or X and y have different sizes.
+    PipelineStats train(const Dataset &data, int steps, int microbatchSize, DataType learningRate,
+                        DataType alpha = 1e-4);
+
+    /// Layer indices [first, last) of every stage.
+    [[nodiscard]] const std::vector<std::pair<int, int>> &stages() const;
+
+private:
+    MLP &_model;
+    std::vector<std::pair<int, int>> _stages;
+};
+
+#endif //MICROGRAD_PIPELINE_H
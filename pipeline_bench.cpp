@@ -0,0 +1,58 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "loss.h"
+#include "pipeline.h"
+
+/// Train a deep MLP with the single-threaded MLP::operator() path, then the same model with pipeline stages,
+/// and compare throughput.
+int main() {
+    auto data = Dataset::read("data/moonX.csv", "data/moonY.csv");
+    if (data.X.size() != data.y.size()) {
+        std::cout << "X and y have different sizes.";
+        exit(1);
+    }
+    int N = data.X.size();
+    std::vector<int> nOuts = {48, 48, 48, 48, 48, 48, 1};
+    int steps = 5;
+    int stages = 4;
+    int microbatchSize = 4;
+    DataType learningRate = 0.1, alpha = 1e-4;
+
+    std::mt19937 gen(42);
+    MLP model(2, nOuts, gen);
+    auto X = data.values();
+    auto params = model.parameters();
+    DataType loss = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < steps; ++k) {
+        // the pipeline applies the regularization as weight decay in its update, do the same here
+        auto dataLoss = demo_loss(model, X, data.y, 0);
+        dataLoss.backward();
+        loss = dataLoss->data();
+        double rate = learningRate * (1.0 - 0.9 * k / steps);
+        for (auto &p: params) {
+            p->data() -= rate * (p->grad() + 2 * alpha * p->data());
+            p->grad() = 0;
+        }
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "single thread: " << N * steps / seconds << " samples/s, last loss " << loss << "\n";
+
+    std::mt19937 pipelineGen(42);
+    MLP pipelineModel(2, nOuts, pipelineGen);
+    Pipeline pipeline(pipelineModel, stages);
+    std::cout << "stages:";
+    for (auto [first, last]: pipeline.stages()) {
+        std::cout << " [" << first << ", " << last << ")";
+    }
+    std::cout << "\n";
+    auto stats = pipeline.train(data, steps, microbatchSize, learningRate, alpha);
+    std::cout << "pipeline: " << stats.samplesPerSecond << " samples/s, last loss " << stats.loss << ", "
+              << stats.microbatches << " microbatches, bubble " << stats.bubbleFraction * 100 << "% (ideal "
+              << stats.idealBubbleFraction * 100 << "%), speedup " << stats.samplesPerSecond / (N * steps / seconds)
+              << "\n";
+}
@@ -0,0 +1,262 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include "pool.h"
+
+namespace {
+    constexpr std::size_t SlabSize = 64 * 1024;
+    constexpr std::size_t Granularity = 16;
+    constexpr std::size_t MaxBlockSize = 1024;
+    constexpr std::size_t NumClasses = MaxBlockSize / Granularity;
+    /// Set on `Slab::live` once the owning thread has exited.
+    constexpr uint32_t Orphaned = 1u << 31;
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    class SlabPool;
+
+    /**
+     * A SlabSize-aligned chunk carved into equal blocks, the header sits at the start of the chunk
+     * so the slab of any block is found by masking its address.
+     */
+    struct Slab {
+        SlabPool *owner;
+        /// Number of allocated blocks, plus the Orphaned bit.
+        std::atomic<uint32_t> live;
+        /// Blocks freed by other threads.
+        std::atomic<FreeBlock *> remote;
+        /// Blocks freed by the owning thread.
+        FreeBlock *local;
+        char *bump;
+        char *end;
+        uint32_t capacity;
+    };
+
+    constexpr std::size_t HeaderSize = (sizeof(Slab) + Granularity - 1) / Granularity * Granularity;
+
+    Slab *slabOf(void *p) {
+        return reinterpret_cast<Slab *>(reinterpret_cast<std::uintptr_t>(p) & ~(SlabSize - 1));
+    }
+
+    /// Forget every block of an empty slab at once.
+    void reset(Slab *slab) {
+        slab->local = nullptr;
+        slab->remote.store(nullptr, std::memory_order_relaxed);
+        slab->bump = reinterpret_cast<char *>(slab) + HeaderSize;
+    }
+
+    /// Release a block owned by another thread (or by a thread that has exited).
+    void releaseRemote(Slab *slab, void *p) {
+        auto block = static_cast<FreeBlock *>(p);
+        block->next = slab->remote.load(std::memory_order_relaxed);
+        while (!slab->remote.compare_exchange_weak(block->next, block, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {}
+        if (slab->live.fetch_sub(1, std::memory_order_acq_rel) == (Orphaned | 1)) {
+            std::free(slab);
+        }
+    }
+
+    /**
+     * Slabs of a single size class, owned by one thread.
+     */
+    class SlabPool {
+    public:
+        explicit SlabPool(std::size_t blockSize) : _blockSize(blockSize) {}
+
+        ~SlabPool() {
+            for (auto slab: _slabs) {
+                if ((slab->live.fetch_or(Orphaned, std::memory_order_acq_rel) & ~Orphaned) == 0) {
+                    std::free(slab);
+                }
+            }
+        }
+
+        void *allocate() {
+            if (_current) {
+                if (auto p = take(_current)) return p;
+            }
+            // try a few other slabs before growing, the cursor makes every slab come around eventually
+            for (std::size_t k = 0; k < std::min<std::size_t>(_slabs.size(), 8); ++k) {
+                _cursor = (_cursor + 1) % _slabs.size();
+                auto slab = _slabs[_cursor];
+                if (slab != _current && slab->live.load(std::memory_order_relaxed) < slab->capacity) {
+                    if (auto p = take(slab)) {
+                        _current = slab;
+                        return p;
+                    }
+                }
+            }
+            _current = newSlab();
+            return take(_current);
+        }
+
+        /// Release a block of one of our slabs from the owning thread.
+        static void release(Slab *slab, void *p) {
+            auto block = static_cast<FreeBlock *>(p);
+            block->next = slab->local;
+            slab->local = block;
+            if (slab->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // the last block of e.g. a training step's graph: the whole slab is free again
+                reset(slab);
+            }
+        }
+
+        std::size_t trim() {
+            std::size_t released = 0;
+            std::erase_if(_slabs, [&](Slab *slab) {
+                if (slab->live.load(std::memory_order_acquire) != 0) return false;
+                if (slab == _current) _current = nullptr;
+                std::free(slab);
+                ++released;
+                return true;
+            });
+            _cursor = 0;
+            return released;
+        }
+
+        [[nodiscard]] std::size_t slabCount() const {
+            return _slabs.size();
+        }
+
+        [[nodiscard]] bool empty() const {
+            return std::ranges::all_of(_slabs, [](Slab *slab) {
+                return slab->live.load(std::memory_order_acquire) == 0;
+            });
+        }
+
+    private:
+        void *take(Slab *slab) const {
+            if (slab->live.load(std::memory_order_acquire) == 0) {
+                reset(slab);
+            }
+            FreeBlock *block = slab->local;
+            if (!block) {
+                block = slab->remote.exchange(nullptr, std::memory_order_acquire);
+            }
+            if (block) {
+                slab->local = block->next;
+            } else if (slab->bump + _blockSize <= slab->end) {
+                block = reinterpret_cast<FreeBlock *>(slab->bump);
+                slab->bump += _blockSize;
+            } else {
+                return nullptr;
+            }
+            slab->live.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+
+        Slab *newSlab() {
+            void *mem = std::aligned_alloc(SlabSize, SlabSize);
+            if (!mem) throw std::bad_alloc();
+            auto slab = new(mem) Slab{this, {0}, {nullptr}, nullptr, nullptr, nullptr, 0};
+            reset(slab);
+            slab->end = static_cast<char *>(mem) + SlabSize;
+            slab->capacity = uint32_t((SlabSize - HeaderSize) / _blockSize);
+            _slabs.push_back(slab);
+            return slab;
+        }
+
+        std::size_t _blockSize;
+        Slab *_current = nullptr;
+        std::vector<Slab *> _slabs;
+        std::size_t _cursor = 0;
+    };
+
+    using ThreadPools = std::array<std::unique_ptr<SlabPool>, NumClasses>;
+
+    // A trivially destructible pointer plus a guard, so that nodes released during thread teardown
+    // (after the guard ran) still find a valid state.
+    thread_local ThreadPools *threadPools = nullptr;
+
+    struct ThreadPoolsGuard {
+        ~ThreadPoolsGuard() {
+            delete threadPools;
+            threadPools = nullptr;
+        }
+    };
+
+    thread_local ThreadPoolsGuard threadPoolsGuard;
+
+    ThreadPools &pools() {
+        if (!threadPools) {
+            threadPools = new ThreadPools();
+            (void) &threadPoolsGuard;
+        }
+        return *threadPools;
+    }
+
+    std::size_t sizeClass(std::size_t size) {
+        return (size + Granularity - 1) / Granularity - 1;
+    }
+
+    std::atomic<bool> useSystem{false};
+}
+
+void *pool_allocate(std::size_t size) {
+    if (size == 0 || size > MaxBlockSize || useSystem.load(std::memory_order_relaxed)) {
+        return ::operator new(size);
+    }
+    auto idx = sizeClass(size);
+    auto &pool = pools()[idx];
+    if (!pool) {
+        pool = std::make_unique<SlabPool>((idx + 1) * Granularity);
+    }
+    return pool->allocate();
+}
+
+void pool_deallocate(void *p, std::size_t size) noexcept {
+    if (!p) return;
+    if (size == 0 || size > MaxBlockSize || useSystem.load(std::memory_order_relaxed)) {
+        ::operator delete(p);
+        return;
+    }
+    auto slab = slabOf(p);
+    SlabPool *pool = threadPools ? (*threadPools)[sizeClass(size)].get() : nullptr;
+    // an orphaned slab may carry the address of a since-reused pool, never treat it as local
+    if (pool && slab->owner == pool && !(slab->live.load(std::memory_order_relaxed) & Orphaned)) {
+        SlabPool::release(slab, p);
+    } else {
+        releaseRemote(slab, p);
+    }
+}
+
+std::size_t pool_trim() {
+    std::size_t released = 0;
+    if (threadPools) {
+        for (auto &pool: *threadPools) {
+            if (pool) released += pool->trim();
+        }
+    }
+    return released;
+}
+
+std::size_t pool_slab_count() {
+    std::size_t count = 0;
+    if (threadPools) {
+        for (auto &pool: *threadPools) {
+            if (pool) count += pool->slabCount();
+        }
+    }
+    return count;
+}
+
+void pool_use_system(bool system) {
+    if (threadPools) {
+        for (auto &pool: *threadPools) {
+            if (pool && !pool->empty()) throw std::logic_error("pool_use_system: pools still hold live blocks");
+        }
+    }
+    useSystem.store(system, std::memory_order_relaxed);
+}
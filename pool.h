@@ -0,0 +1,58 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_POOL_H
+#define MICROGRAD_POOL_H
+
+#include <cstddef>
+
+/// Allocate `size` bytes from the calling thread's slab pool of the matching size class.
+/// Sizes above the largest size class go to the system allocator.
+void *pool_allocate(std::size_t size);
+
+/// Return a block obtained from pool_allocate, can be called from any thread.
+void pool_deallocate(void *p, std::size_t size) noexcept;
+
+/// Give the calling thread's empty slabs back to the system, returns the number of slabs released.
+std::size_t pool_trim();
+
+/// Number of slabs currently held by the calling thread's pools.
+std::size_t pool_slab_count();
+
+/// Route pool_allocate and pool_deallocate of every thread to the system allocator, for comparisons.
+/// Blocks must be freed in the mode they were allocated in, throws std::logic_error if the calling thread's
+/// pools still hold live blocks.
+void pool_use_system(bool system);
+
+/**
+ * Standard allocator backed by thread-local, size-class slab pools.
+ * Used with std::allocate_shared so that the object and its control block share one pooled block.
+ */
+template<typename T>
+class PoolAllocator {
+    static_assert(alignof(T) <= 16, "pool blocks are only 16-byte aligned");
+
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(pool_allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        pool_deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U> &) const noexcept {
+        return true;
+    }
+};
+
+#endif //MICROGRAD_POOL_H
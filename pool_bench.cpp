@@ -0,0 +1,81 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "engine.h"
+#include "neuronet.h"
+#include "pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double ms(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+/// Build `n` leaves and `n` binary nodes on top of them, then drop them all; returns {create, teardown} in ms.
+template<typename Make>
+std::pair<double, double> nodes(int n, Make make) {
+    std::vector<ValueDataPtr> all;
+    all.reserve(2 * n);
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; ++i) {
+        all.push_back(make(DataType(i), "val", ValueData::Prev{}));
+    }
+    for (int i = 0; i < n; ++i) {
+        all.push_back(make(DataType(i), "+", ValueData::Prev{all[i], all[(i * 7) % n]}));
+    }
+    auto t1 = Clock::now();
+    all.clear();
+    auto t2 = Clock::now();
+    return {ms(t1 - t0), ms(t2 - t1)};
+}
+
+/// A few training steps of the demo-sized model, the model and its inputs are released at the end so that
+/// every block is freed in the allocator mode it was taken in.
+void steps(const char *name) {
+    MLP model(2, {16, 16, 1});
+    Vector2D X;
+    for (int i = 0; i < 100; ++i) {
+        X.push_back({Value(i / 100.0), Value(1 - i / 100.0)});
+    }
+    for (int k = 0; k < 5; ++k) {
+        auto t0 = Clock::now();
+        {
+            Value loss(0);
+            for (auto &x: X) {
+                loss += model(x)[0].relu();
+            }
+            loss.backward();
+        }
+        auto t1 = Clock::now();
+        std::cout << name << " step " << k << ": build + backward + release " << ms(t1 - t0) << "ms, slabs held "
+                  << pool_slab_count() << "\n";
+    }
+}
+
+/// Node creation and teardown with the system allocator versus the slab pools,
+/// then training steps of the demo-sized model with both, showing slabs being reused across steps.
+int main() {
+    int n = 1'000'000;
+    int rounds = 5;
+    for (int r = 0; r < rounds; ++r) {
+        auto sys = nodes(n, [](DataType d, const char *op, ValueData::Prev prev) {
+            return std::make_shared<ValueData>(d, op, std::move(prev), "");
+        });
+        auto pooled = nodes(n, [](DataType d, const char *op, ValueData::Prev prev) {
+            return std::allocate_shared<ValueData>(PoolAllocator<ValueData>(), d, op, std::move(prev), "");
+        });
+        std::cout << "round " << r << ": " << 2 * n << " nodes, system create " << sys.first << "ms teardown "
+                  << sys.second << "ms | pool create " << pooled.first << "ms teardown " << pooled.second << "ms\n";
+    }
+
+    // start the model runs from empty pools
+    std::cout << "trimmed " << pool_trim() << " empty slabs\n";
+    pool_use_system(true);
+    steps("system");
+    pool_use_system(false);
+    steps("pool");
+    std::cout << "trimmed " << pool_trim() << " empty slabs, slabs held " << pool_slab_count() << "\n";
+}
@@ -0,0 +1,261 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include "quantize.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MICROGRAD_DOT_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    int32_t dotScalar(const int8_t *a, const int8_t *b, int n, int i, int32_t sum) {
+        for (; i < n; ++i) {
+            sum += int32_t(a[i]) * int32_t(b[i]);
+        }
+        return sum;
+    }
+
+#ifdef MICROGRAD_DOT_AVX2
+    /// Compiled for AVX2 whatever the target flags are, only called when the cpu supports it.
+    __attribute__((target("avx2")))
+    int32_t dotAvx2(const int8_t *a, const int8_t *b, int n) {
+        // widen 16 lanes to int16, multiply-add pairs into 8 int32 lanes
+        int i = 0;
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 16 <= n; i += 16) {
+            __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+            __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        s = _mm_hadd_epi32(s, s);
+        s = _mm_hadd_epi32(s, s);
+        return dotScalar(a, b, n, i, _mm_cvtsi128_si32(s));
+    }
+#endif
+}
+
+int32_t dot_i8(const int8_t *a, const int8_t *b, int n) {
+#ifdef MICROGRAD_DOT_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) return dotAvx2(a, b, n);
+    return dotScalar(a, b, n, 0, 0);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // NEON is part of the aarch64 baseline, no dispatch needed.
+    // int8 x int8 fits in int16, pairwise accumulate into 4 int32 lanes
+    int i = 0;
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+    }
+    return dotScalar(a, b, n, i, vaddvq_s32(acc));
+#else
+    return dotScalar(a, b, n, 0, 0);
+#endif
+}
+
+bool dot_i8_simd() {
+#ifdef MICROGRAD_DOT_AVX2
+    return __builtin_cpu_supports("avx2");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+namespace {
+    constexpr DataType TanhRange = 6.0;
+    constexpr int TanhSteps = 1024;
+
+    /// tanh sampled on [-TanhRange, TanhRange], TanhSteps intervals.
+    const std::array<DataType, TanhSteps + 1> &tanhTable() {
+        static const auto table = [] {
+            std::array<DataType, TanhSteps + 1> t{};
+            for (int i = 0; i <= TanhSteps; ++i) {
+                t[i] = std::tanh(-TanhRange + 2 * TanhRange * i / TanhSteps);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    int8_t quantize(DataType x, DataType scale) {
+        return int8_t(std::clamp(std::round(x / scale), -127.0, 127.0));
+    }
+
+    /// Scale that maps [-maxAbs, maxAbs] onto [-127, 127].
+    DataType scaleOf(DataType maxAbs) {
+        return maxAbs > 0 ? maxAbs / 127 : 1;
+    }
+
+    std::vector<DataType> toData(const Vector &x) {
+        std::vector<DataType> ret;
+        ret.reserve(x.size());
+        for (auto &v: x) {
+            ret.push_back(v->data());
+        }
+        return ret;
+    }
+}
+
+std::vector<DataType> forward(const Layer &layer, const std::vector<DataType> &x) {
+    std::vector<DataType> out;
+    out.reserve(layer.neurons().size());
+    for (auto &n: layer.neurons()) {
+        DataType r = n.bias()->data();
+        for (size_t i = 0; i < x.size(); ++i) {
+            r += x[i] * n.weights()[i]->data();
+        }
+        out.push_back(std::tanh(r));
+    }
+    return out;
+}
+
+std::vector<DataType> forward(const MLP &model, const std::vector<DataType> &x) {
+    std::vector<DataType> t = x;
+    for (auto &layer: model.layers()) {
+        t = forward(layer, t);
+    }
+    return t;
+}
+
+DataType tanh_lut(DataType x) {
+    auto &table = tanhTable();
+    if (x <= -TanhRange) return table.front();
+    if (x >= TanhRange) return table.back();
+    DataType pos = (x + TanhRange) * (TanhSteps / (2 * TanhRange));
+    int i = std::min(int(pos), TanhSteps - 1);
+    DataType frac = pos - i;
+    return table[i] + frac * (table[i + 1] - table[i]);
+}
+
+QuantizedMLP::QuantizedMLP(const MLP &model, const Vector2D &calibration, QuantGranularity granularity) {
+    // max |input| of every layer over the calibration set
+    std::vector<DataType> inputMaxAbs(model.layers().size(), 0);
+    for (auto &sample: calibration) {
+        auto x = toData(sample);
+        for (size_t l = 0; l < model.layers().size(); ++l) {
+            for (auto v: x) {
+                inputMaxAbs[l] = std::max(inputMaxAbs[l], std::abs(v));
+            }
+            x = forward(model.layers()[l], x);
+        }
+    }
+
+    for (size_t l = 0; l < model.layers().size(); ++l) {
+        auto &neurons = model.layers()[l].neurons();
+        QuantizedLayer q;
+        q.nOut = int(neurons.size());
+        q.nIn = neurons.empty() ? 0 : int(neurons.front().weights().size());
+        q.inputScale = scaleOf(inputMaxAbs[l]);
+
+        std::vector<DataType> rowMaxAbs(q.nOut, 0);
+        for (int j = 0; j < q.nOut; ++j) {
+            for (auto &w: neurons[j].weights()) {
+                rowMaxAbs[j] = std::max(rowMaxAbs[j], std::abs(w->data()));
+            }
+        }
+        if (granularity == QuantGranularity::PerLayer) {
+            q.weightScales.push_back(scaleOf(*std::max_element(rowMaxAbs.begin(), rowMaxAbs.end())));
+        } else {
+            for (auto m: rowMaxAbs) {
+                q.weightScales.push_back(scaleOf(m));
+            }
+        }
+
+        q.weights.reserve(size_t(q.nOut) * q.nIn);
+        q.biases.reserve(q.nOut);
+        for (int j = 0; j < q.nOut; ++j) {
+            auto ws = q.weightScales[q.weightScales.size() == 1 ? 0 : j];
+            for (auto &w: neurons[j].weights()) {
+                q.weights.push_back(quantize(w->data(), ws));
+            }
+            auto b = std::round(neurons[j].bias()->data() / (q.inputScale * ws));
+            q.biases.push_back(int32_t(std::clamp(b, DataType(std::numeric_limits<int32_t>::min()),
+                                                  DataType(std::numeric_limits<int32_t>::max()))));
+        }
+        _layers.push_back(std::move(q));
+    }
+}
+
+std::vector<DataType> QuantizedMLP::operator()(const std::vector<DataType> &x) const {
+    std::vector<DataType> t = x;
+    std::vector<int8_t> qx;
+    for (auto &layer: _layers) {
+        qx.resize(layer.nIn);
+        for (int i = 0; i < layer.nIn; ++i) {
+            qx[i] = quantize(t[i], layer.inputScale);
+        }
+        t.resize(layer.nOut);
+        for (int j = 0; j < layer.nOut; ++j) {
+            auto ws = layer.weightScales[layer.weightScales.size() == 1 ? 0 : j];
+            int32_t acc = layer.biases[j] + dot_i8(layer.weights.data() + size_t(j) * layer.nIn, qx.data(), layer.nIn);
+            t[j] = tanh_lut(acc * layer.inputScale * ws);
+        }
+    }
+    return t;
+}
+
+std::vector<DataType> QuantizedMLP::operator()(const Vector &x) const {
+    return (*this)(toData(x));
+}
+
+const std::vector<QuantizedLayer> &QuantizedMLP::layers() const {
+    return _layers;
+}
+
+size_t QuantizedMLP::bytes() const {
+    size_t ret = 0;
+    for (auto &l: _layers) {
+        ret += l.weights.size() * sizeof(int8_t) + l.weightScales.size() * sizeof(DataType) +
+               l.biases.size() * sizeof(int32_t) + sizeof(DataType);
+    }
+    return ret;
+}
+
+QuantizationReport compare(const MLP &model, const QuantizedMLP &quantized, const Vector2D &X, const Vector &y) {
+    QuantizationReport report;
+    for (size_t i = 0; i < X.size(); ++i) {
+        DataType expected = forward(model, toData(X[i]))[0];
+        DataType actual = quantized(X[i])[0];
+        bool label = y[i]->data() > 0;
+        report.accuracy += label == (expected > 0);
+        report.quantizedAccuracy += label == (actual > 0);
+        report.agreement += (expected > 0) == (actual > 0);
+        report.maxAbsError = std::max(report.maxAbsError, std::abs(expected - actual));
+        report.meanAbsError += std::abs(expected - actual);
+    }
+    if (!X.empty()) {
+        report.accuracy /= X.size();
+        report.quantizedAccuracy /= X.size();
+        report.agreement /= X.size();
+        report.meanAbsError /= X.size();
+    }
+    for (auto &layer: model.layers()) {
+        for (auto &n: layer.neurons()) {
+            report.bytes += (n.weights().size() + 1) * sizeof(DataType);
+        }
+    }
+    report.quantizedBytes = quantized.bytes();
+    return report;
+}
+
+std::ostream &operator<<(std::ostream &out, const QuantizationReport &report) {
+    out << "accuracy " << report.accuracy * 100 << "% -> " << report.quantizedAccuracy * 100 << "% (delta "
+        << (report.quantizedAccuracy - report.accuracy) * 100 << "%), agreement " << report.agreement * 100
+        << "%, output error max " << report.maxAbsError << " mean " << report.meanAbsError << ", weights "
+        << report.bytes << " -> " << report.quantizedBytes << " bytes";
+    return out;
+}
@@ -0,0 +1,89 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_QUANTIZE_H
+#define MICROGRAD_QUANTIZE_H
+
+#include <cstdint>
+#include "neuronet.h"
+
+/// Int8 dot product with int32 accumulation. The AVX2 kernel is picked at runtime when the cpu supports it
+/// (no -mavx2 needed), NEON is always used on aarch64.
+int32_t dot_i8(const int8_t *a, const int8_t *b, int n);
+
+/// True if dot_i8 runs a SIMD kernel on this machine.
+bool dot_i8_simd();
+
+/// tanh approximated with a linear-interpolated lookup table, saturates outside [-6, 6].
+DataType tanh_lut(DataType x);
+
+/// Plain double forward of a layer, no graph is built.
+std::vector<DataType> forward(const Layer &layer, const std::vector<DataType> &x);
+
+/// Plain double forward of a model, no graph is built: the baseline the quantized model is compared with.
+std::vector<DataType> forward(const MLP &model, const std::vector<DataType> &x);
+
+/// How weight scales are shared.
+enum class QuantGranularity {
+    PerLayer,
+    PerNeuron,
+};
+
+/**
+ * A layer with int8 weights: out[j] = tanh(s_x * s_w[j] * (b[j] + sum_i w[j][i] * x[i])).
+ */
+struct QuantizedLayer {
+    int nIn = 0;
+    int nOut = 0;
+    /// Weights in row-major order: nOut rows of nIn.
+    std::vector<int8_t> weights;
+    /// Scale of each row, a single entry if the granularity is per layer.
+    std::vector<DataType> weightScales;
+    /// Bias quantized to the accumulator scale (s_x * s_w[j]).
+    std::vector<int32_t> biases;
+    /// Scale of the layer input, calibrated on sample data.
+    DataType inputScale = 1;
+};
+
+/**
+ * Post-training int8 quantization of a trained MLP.
+ * Weights are quantized symmetrically, input activations of each layer are calibrated
+ * on a sample dataset.
+ */
+class QuantizedMLP {
+public:
+    QuantizedMLP(const MLP &model, const Vector2D &calibration,
+                 QuantGranularity granularity = QuantGranularity::PerNeuron);
+
+    std::vector<DataType> operator()(const std::vector<DataType> &x) const;
+
+    std::vector<DataType> operator()(const Vector &x) const;
+
+    [[nodiscard]] const std::vector<QuantizedLayer> &layers() const;
+
+    /// Bytes used by the quantized weights, scales and biases.
+    [[nodiscard]] size_t bytes() const;
+
+private:
+    std::vector<QuantizedLayer> _layers;
+};
+
+/// Quality of a quantized model compared to the double model it was built from.
+struct QuantizationReport {
+    DataType accuracy = 0;
+    DataType quantizedAccuracy = 0;
+    /// Fraction of samples where both models predict the same class.
+    DataType agreement = 0;
+    DataType maxAbsError = 0;
+    DataType meanAbsError = 0;
+    size_t bytes = 0;
+    size_t quantizedBytes = 0;
+};
+
+/// Compare a quantized model with the original one, labels are -1/1 and the first output's sign is the prediction.
+QuantizationReport compare(const MLP &model, const QuantizedMLP &quantized, const Vector2D &X, const Vector &y);
+
+std::ostream &operator<<(std::ostream &out, const QuantizationReport &report);
+
+#endif //MICROGRAD_QUANTIZE_H
@@ -0,0 +1,57 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "engine.h"
+#include "neuronet.h"
+#include "dataset.h"
+#include "loss.h"
+#include "quantize.h"
+
+/// Train the demo model on the moon dataset, then compare int8 inference with the double model.
+int main() {
+    auto data = Dataset::read("data/moonX.csv", "data/moonY.csv");
+    if (data.X.size() != data.y.size()) {
+        std::cout << "X and y have different sizes.";
+        exit(1);
+    }
+    auto X = data.values();
+    Vector y(data.y.begin(), data.y.end());
+
+    MLP model(2, {16, 16, 1});
+    auto params = model.parameters();
+    int n = 100;
+    for (int k = 0; k < n; ++k) {
+        demo_loss(model, X, data.y).backward();
+        double learningRate = 1.0 - 0.9 * k / n;
+        for (auto &p: params) {
+            p->data() -= learningRate * p->grad();
+            p->grad() = 0;
+        }
+    }
+
+    for (auto granularity: {QuantGranularity::PerLayer, QuantGranularity::PerNeuron}) {
+        QuantizedMLP quantized(model, X, granularity);
+        std::cout << (granularity == QuantGranularity::PerLayer ? "per layer:  " : "per neuron: ")
+                  << compare(model, quantized, X, y) << "\n";
+    }
+
+    // inference time over the whole dataset, both models on plain arrays (model(x) would build a graph)
+    QuantizedMLP quantized(model, X);
+    int repeat = 100;
+    DataType sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        for (auto &x: data.X) sink += forward(model, x)[0];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        for (auto &x: data.X) sink += quantized(x)[0];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    auto us = [](auto d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::cout << "inference x" << repeat << (dot_i8_simd() ? " (simd)" : " (scalar)") << ": double " << us(t1 - t0)
+              << "us, int8 " << us(t2 - t1) << "us (checksum " << sink << ")\n";
+}
@@ -0,0 +1,87 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "engine.h"
+#include "neuronet.h"
+
+using Clock = std::chrono::steady_clock;
+
+/// Average us of `repeat` calls of fn.
+template<typename F>
+double timeUs(int repeat, F fn) {
+    auto t0 = Clock::now();
+    for (int r = 0; r < repeat; ++r) fn();
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / repeat;
+}
+
+/// Check IncrementalGraph against fresh graphs, then time a one-leaf change at the end and at the start of the
+/// demo model against a full rebuild.
+int main() {
+    std::mt19937 gen(3);
+    DataType maxDiff = 0;
+
+    // two outputs sharing every weight: both see the change
+    MLP twoOutputs(2, {16, 16, 2}, gen);
+    Vector x = {Value(0.5), Value(-1.0)};
+    auto out = twoOutputs(x);
+    IncrementalGraph outputs(out);
+    twoOutputs.layers()[0].neurons()[3].weights()[1]->data() += 0.5;
+    auto count = outputs.recompute();
+    auto fresh = twoOutputs(x);
+    for (size_t i = 0; i < out.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(out[i]->data() - fresh[i]->data()));
+    }
+    std::cout << "shared weight: " << count << " nodes re-evaluated, max difference " << maxDiff << "\n";
+
+    // grads of the changed leaf match a full backward, the unchanged ones are left alone
+    Value p(2), q(3);
+    Value l = p * q + q * q;
+    IncrementalGraph small(l);
+    p->data() = 4;
+    small.recompute();
+    small.backward();
+    DataType dp = p->grad(), dq = q->grad();
+    p->grad() = q->grad() = 0;
+    l.backward();
+    std::cout << "l = p*q + q*q, p changed: dp " << dp << " (full backward " << p->grad() << "), dq left at " << dq
+              << "\n";
+
+    MLP model(2, {16, 16, 1}, gen);
+    Value score = model(x)[0];
+    IncrementalGraph graph(score);
+    auto &lastBias = model.layers().back().neurons()[0].bias();
+    int repeat = 2000;
+    DataType delta = 1e-3;
+
+    size_t nodes = 0;
+    auto tBias = timeUs(repeat, [&] {
+        lastBias->data() += delta;
+        delta = -delta;
+        nodes = graph.recompute();
+    });
+    std::cout << graph.size() << " nodes, last bias changed: " << nodes << " re-evaluated, " << tBias << "us\n";
+
+    auto tInput = timeUs(repeat, [&] {
+        x[0]->data() += delta;
+        delta = -delta;
+        nodes = graph.recompute();
+    });
+    std::cout << "input changed: " << nodes << " re-evaluated, " << tInput << "us\n";
+
+    auto tBackward = timeUs(repeat, [&] {
+        lastBias->data() += delta;
+        delta = -delta;
+        graph.recompute();
+        graph.backward();
+    });
+    std::cout << "last bias changed + backward: " << tBackward << "us\n";
+
+    auto tRebuild = timeUs(repeat, [&] {
+        model(x)[0].backward();
+    });
+    std::cout << "rebuild + backward: " << tRebuild << "us\n";
+    std::cout << "score " << score->data() << " vs fresh " << model(x)[0]->data() << "\n";
+}
@@ -0,0 +1,82 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include "graph.h"
+#include "loss.h"
+#include "sweep.h"
+
+SweepResult train(const SweepConfig &config, const Dataset &data) {
+    auto t0 = std::chrono::steady_clock::now();
+    SweepResult result{config};
+
+    std::mt19937 gen(config.seed);
+    MLP model(int(data.X.front().size()), config.nOuts, gen);
+    auto params = model.parameters();
+    auto X = data.values();
+    size_t N = X.size();
+
+    // the loss of demo.cpp, captured once and executed on every step
+    Graph graph(demo_loss(model, X, data.y, config.alpha), params);
+    graph.optimize();
+
+    DataType best = std::numeric_limits<DataType>::infinity();
+    int sinceBest = 0;
+    for (int k = 0; k < config.maxSteps; ++k) {
+        result.loss = graph.forward();
+        result.steps = k + 1;
+        graph.backward();
+        double learningRate = config.learningRate * (1.0 - 0.9 * k / config.maxSteps);
+        for (auto &p: params) {
+            p->data() -= learningRate * p->grad();
+            p->grad() = 0;
+        }
+
+        if (result.loss < best - config.minDelta) {
+            best = result.loss;
+            sinceBest = 0;
+        } else if (++sinceBest >= config.patience) {
+            result.stoppedEarly = true;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < N; ++i) {
+        result.accuracy += (data.y[i] > 0) == (model(X[i])[0]->data() > 0);
+    }
+    result.accuracy /= N;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+std::vector<SweepResult> sweep(const std::vector<SweepConfig> &configs, const Dataset &data, ThreadPool &pool) {
+    std::vector<SweepResult> results(configs.size());
+    for (size_t i = 0; i < configs.size(); ++i) {
+        pool.submit([&, i] {
+            results[i] = train(configs[i], data);
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+void printResults(std::ostream &out, const std::vector<SweepResult> &results) {
+    out << std::left << std::setw(4) << "#" << std::setw(14) << "layers" << std::setw(8) << "lr" << std::setw(10)
+        << "alpha" << std::setw(6) << "seed" << std::setw(7) << "steps" << std::setw(12) << "loss" << std::setw(10)
+        << "accuracy" << std::setw(7) << "early" << "seconds\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &r = results[i];
+        std::string layers;
+        for (auto n: r.config.nOuts) {
+            layers += (layers.empty() ? "" : "-") + std::to_string(n);
+        }
+        out << std::setw(4) << i << std::setw(14) << layers << std::setw(8) << r.config.learningRate
+            << std::setw(10) << r.config.alpha << std::setw(6) << r.config.seed << std::setw(7) << r.steps
+            << std::setw(12) << r.loss << std::setw(10) << r.accuracy * 100 << std::setw(7)
+            << (r.stoppedEarly ? "yes" : "no") << r.seconds << "\n";
+    }
+    out << std::right;
+}
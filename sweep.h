@@ -0,0 +1,46 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_SWEEP_H
+#define MICROGRAD_SWEEP_H
+
+#include "dataset.h"
+#include "neuronet.h"
+#include "threadpool.h"
+
+/// Hyperparameters of one model of a sweep, trained as in demo.cpp.
+struct SweepConfig {
+    std::vector<int> nOuts;
+    /// Initial learning rate, decayed linearly to 10% over maxSteps.
+    DataType learningRate = 1.0;
+    /// L2 regularization strength.
+    DataType alpha = 1e-4;
+    /// Seed of the weight initialization.
+    unsigned seed = 0;
+    int maxSteps = 200;
+    /// Stop after this many steps without the loss improving by at least minDelta.
+    int patience = 10;
+    DataType minDelta = 1e-5;
+};
+
+struct SweepResult {
+    SweepConfig config;
+    int steps = 0;
+    DataType loss = 0;
+    DataType accuracy = 0;
+    bool stoppedEarly = false;
+    double seconds = 0;
+};
+
+/// Train a single model on binary -1/1 labels with demo_loss, captured once as a Graph.
+SweepResult train(const SweepConfig &config, const Dataset &data);
+
+/// Train every config concurrently on the pool, all of them reading the same dataset.
+/// An exception thrown by one of the runs is rethrown once every run has finished.
+std::vector<SweepResult> sweep(const std::vector<SweepConfig> &configs, const Dataset &data, ThreadPool &pool);
+
+/// Write the results as a table, one row per model.
+void printResults(std::ostream &out, const std::vector<SweepResult> &results);
+
+#endif //MICROGRAD_SWEEP_H
@@ -0,0 +1,38 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <chrono>
+#include <iostream>
+#include "sweep.h"
+
+/// Sweep layer sizes, learning rates, regularization and seeds on the moon dataset using every core.
+int main() {
+    auto data = Dataset::read("data/moonX.csv", "data/moonY.csv");
+    if (data.X.size() != data.y.size()) {
+        std::cout << "X and y have different sizes.";
+        exit(1);
+    }
+
+    std::vector<SweepConfig> configs;
+    for (auto &nOuts: std::vector<std::vector<int>>{{8, 1}, {16, 16, 1}, {32, 32, 1}}) {
+        for (auto learningRate: {0.5, 1.0}) {
+            for (auto alpha: {1e-4, 1e-3}) {
+                for (unsigned seed: {1, 2}) {
+                    configs.push_back({nOuts, learningRate, alpha, seed});
+                }
+            }
+        }
+    }
+
+    ThreadPool pool;
+    std::cout << "Training " << configs.size() << " models on " << pool.size() << " threads\n";
+    auto t0 = std::chrono::steady_clock::now();
+    auto results = sweep(configs, data, pool);
+    auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printResults(std::cout, results);
+    double busy = 0;
+    for (auto &r: results) busy += r.seconds;
+    std::cout << "wall " << wall << "s, sum of runs " << busy << "s, speedup " << busy / wall << "\n";
+}
@@ -0,0 +1,153 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#include <algorithm>
+#include <utility>
+#include "threadpool.h"
+
+namespace {
+    /// Pool and index of the worker running on the current thread, if any.
+    thread_local ThreadPool *currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        _threads.emplace_back([this, i] { _run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto &t: _threads) {
+        t.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t target;
+    {
+        std::lock_guard lock(_mutex);
+        target = currentPool == this ? currentWorker : _next++ % _queues.size();
+        ++_pending;
+        // counted under the lock so that a worker about to sleep cannot miss it
+        ++_queued;
+    }
+    {
+        std::lock_guard lock(_queues[target]->mutex);
+        _queues[target]->tasks.push_back(std::move(task));
+    }
+    _wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(_mutex);
+    _done.wait(lock, [this] { return _pending == 0; });
+    if (_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+}
+
+size_t ThreadPool::size() const {
+    return _threads.size();
+}
+
+bool ThreadPool::_pop(size_t self, std::function<void()> &task) {
+    {
+        auto &own = *_queues[self];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --_queued;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < _queues.size(); ++k) {
+        auto &other = *_queues[(self + k) % _queues.size()];
+        std::lock_guard lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            --_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::_run(size_t self) {
+    currentPool = this;
+    currentWorker = self;
+    while (true) {
+        std::function<void()> task;
+        if (_pop(self, task)) {
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(_mutex);
+            if (error && !_error) _error = error;
+            if (--_pending == 0) _done.notify_all();
+            continue;
+        }
+        std::unique_lock lock(_mutex);
+        _wake.wait(lock, [this] { return _stop || _queued > 0; });
+        if (_stop && _queued == 0) return;
+    }
+}
+
+void parallel_for(ThreadPool *pool, size_t n, const std::function<void(size_t, size_t)> &fn) {
+    if (!pool || pool->size() == 1) {
+        fn(0, n);
+        return;
+    }
+    size_t chunk = (n + pool->size() * 4 - 1) / (pool->size() * 4);
+    if (chunk == 0) return;
+
+    // chunks are claimed from a counter by the caller and by helper tasks, the caller runs them too, so it finishes
+    // even when every worker is busy, e.g. when it is itself a task of the pool
+    struct State {
+        std::atomic<size_t> next = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t finished = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    size_t chunks = (n + chunk - 1) / chunk;
+    auto work = [state, &fn, n, chunk, chunks] {
+        for (size_t c; (c = state->next.fetch_add(1)) < chunks;) {
+            std::exception_ptr error;
+            try {
+                fn(c * chunk, std::min(n, (c + 1) * chunk));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(state->mutex);
+            if (error && !state->error) state->error = error;
+            if (++state->finished == chunks) state->done.notify_all();
+        }
+    };
+    // helpers starting after the last chunk was claimed return without touching fn
+    for (size_t i = 1; i < std::min(chunks, pool->size() + 1); ++i) {
+        pool->submit(work);
+    }
+    work();
+    std::unique_lock lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished == chunks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Created by agent on 19/10/2026.
+//
+
+#ifndef MICROGRAD_THREADPOOL_H
+#define MICROGRAD_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing thread pool: every worker owns a deque, runs its own tasks newest first
+ * and steals the oldest tasks of other workers when it runs dry.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Queue a task, tasks submitted from a worker go to that worker's deque.
+    void submit(std::function<void()> task);
+
+    /// Block until every submitted task has finished, then rethrow the first exception a task threw since the last
+    /// wait(), if any: a throwing task does not take the worker down with it.
+    void wait();
+
+    /// Number of worker threads.
+    [[nodiscard]] size_t size() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool _pop(size_t self, std::function<void()> &task);
+
+    void _run(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    /// Tasks waiting in a deque.
+    std::atomic<size_t> _queued = 0;
+    /// Tasks submitted and not finished yet.
+    size_t _pending = 0;
+    size_t _next = 0;
+    bool _stop = false;
+    /// First exception thrown by a task, rethrown by wait().
+    std::exception_ptr _error;
+};
+
+/// Run fn(begin, end) over chunks of [0, n) on the pool and wait for them, or inline if pool is null.
+/// The caller runs chunks as well and only waits for its own chunks, not for other tasks of the pool, so it can be
+/// called from a task of the same pool. The first exception thrown by fn is rethrown.
+void parallel_for(ThreadPool *pool, size_t n, const std::function<void(size_t, size_t)> &fn);
+
+#endif //MICROGRAD_THREADPOOL_H